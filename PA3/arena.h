@@ -0,0 +1,161 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  arena.h
+//
+//  This file implements a chunked bump allocator.  Memory is carved
+//  out of large chunks obtained from the heap; individual allocations
+//  are never freed.  Instead the whole arena is released at once when
+//  it is destroyed, or rewound with reset().
+//
+//     void *alloc(size_t n, size_t align)
+//       returns n bytes aligned to align (a power of two).
+//
+//     char *copy_string(const char *s, int len)
+//       returns a null terminated copy of the first len characters of s.
+//
+//     void reset()
+//       discards everything allocated so far.  The first chunk is kept
+//       for reuse; any others are returned to the heap.
+//
+//     void absorb(Arena &other)
+//       takes ownership of other's chunks, leaving other empty.
+//
+//     size_t bytes_used();   bytes handed out since the last reset
+//     int chunk_count();     chunks currently held
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class Arena {
+private:
+  struct Chunk {
+    Chunk *next;       // the previously allocated chunk
+    size_t size;       // usable bytes following this header
+  };
+
+  Chunk *chunks;       // most recent chunk first
+  char *cur;           // next free byte in the current chunk
+  char *end;           // one past the last byte of the current chunk
+  size_t chunk_size;   // default size of a new chunk
+  size_t used;         // bytes handed out
+  int nchunks;
+
+  Arena(const Arena &);             // not copyable
+  Arena &operator =(const Arena &);
+
+  // Start a new chunk big enough for n bytes at the given alignment.
+  void new_chunk(size_t n, size_t align)
+  {
+    size_t size = n + align > chunk_size ? n + align : chunk_size;
+    Chunk *c = (Chunk *) malloc(sizeof(Chunk) + size);
+    if (c == NULL) {
+      fatal("arena: out of memory");
+    }
+    c->next = chunks;
+    c->size = size;
+    chunks = c;
+    cur = (char *) (c + 1);
+    end = cur + size;
+    nchunks++;
+  }
+
+  static void fatal(const char *msg)
+  {
+    fputs(msg, stderr);
+    fputc('\n', stderr);
+    exit(1);
+  }
+
+public:
+  Arena(size_t chunk = 64 * 1024)
+    : chunks(NULL), cur(NULL), end(NULL), chunk_size(chunk), used(0),
+      nchunks(0) { }
+
+  ~Arena()
+  {
+    while (chunks) {
+      Chunk *next = chunks->next;
+      free(chunks);
+      chunks = next;
+    }
+  }
+
+  void *alloc(size_t n, size_t align = alignof(max_align_t))
+  {
+    size_t pad = (align - ((size_t) cur & (align - 1))) & (align - 1);
+    if (cur == NULL || pad + n > (size_t) (end - cur)) {
+      new_chunk(n, align);
+      pad = (align - ((size_t) cur & (align - 1))) & (align - 1);
+    }
+    char *p = cur + pad;
+    cur = p + n;
+    used += n;
+    return p;
+  }
+
+  char *copy_string(const char *s, int len)
+  {
+    char *p = (char *) alloc(len + 1, 1);
+    memcpy(p, s, len);
+    p[len] = '\0';
+    return p;
+  }
+
+  void reset()
+  {
+    if (chunks == NULL)
+      return;
+    while (chunks->next) {
+      Chunk *next = chunks->next;
+      free(chunks);
+      chunks = next;
+      nchunks--;
+    }
+    cur = (char *) (chunks + 1);
+    end = cur + chunks->size;
+    used = 0;
+  }
+
+  // Take over every chunk of other, leaving it empty.  Allocation
+  // continues in this arena's current chunk.
+  void absorb(Arena &other)
+  {
+    if (other.chunks == NULL)
+      return;
+    if (chunks == NULL) {
+      chunks = other.chunks;
+      cur = other.cur;
+      end = other.end;
+    } else {
+      Chunk *last = other.chunks;
+      while (last->next)
+        last = last->next;
+      last->next = chunks->next;
+      chunks->next = other.chunks;
+    }
+    nchunks += other.nchunks;
+    used += other.used;
+    other.chunks = NULL;
+    other.cur = other.end = NULL;
+    other.nchunks = 0;
+    other.used = 0;
+  }
+
+  size_t bytes_used() const { return used; }
+  int chunk_count() const   { return nchunks; }
+};
+
+#endif
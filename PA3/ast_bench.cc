@@ -0,0 +1,191 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  ast_bench.cc
+//
+//  Parses and checks a Seal program exactly as semant does, lowers the
+//  typed tree into a CompactAst, and compares the two representations:
+//
+//    - the time semant() took on the class AST;
+//    - memory per node: the bytes the class AST took from ast_arena
+//      against the bytes held by the compact arrays;
+//    - dump throughput: dump_with_types on each, written to /dev/null,
+//      after checking that both produce identical output;
+//    - check throughput: recheck_operator_types over the compact nodes;
+//    - the binary format: the time to write the compact AST with
+//      write_binary_ast, to load and check the image, and to rebuild
+//      the class AST from it, after checking that the rebuilt tree
+//      dumps the same as the original.
+//
+//  usage: ast_bench file [rounds]
+//
+//  rounds (default 5) is the number of times each traversal is timed;
+//  the best round is reported.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "seal-decl.h"
+#include "seal-expr.h"
+#include "seal-stmt.h"
+#include "compact-ast.h"
+#include "binary-ast.h"
+
+extern thread_local Program ast_root; // root of the abstract syntax tree
+thread_local FILE *fin;       // input file
+extern int seal_yyparse(void); // entry point to the AST parser
+extern thread_local int omerrs; // syntax check errors
+extern int optind;  // used for option processing (man 3 getopt for more info)
+thread_local char *curr_filename = "<stdin>";
+
+void handle_flags(int argc, char *argv[]);
+
+static double seconds_since(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double best_class_dump(DumpWriter& out, int rounds)
+{
+  double best = 1e30;
+  for (int r = 0; r < rounds; r++) {
+    clock_t start = clock();
+    ast_root->dump_with_types(out, 0);
+    out.flush();
+    double t = seconds_since(start);
+    if (t < best)
+      best = t;
+  }
+  return best;
+}
+
+static double best_compact_dump(CompactAst& ast, DumpWriter& out, int rounds)
+{
+  double best = 1e30;
+  for (int r = 0; r < rounds; r++) {
+    clock_t start = clock();
+    ast.dump_with_types(out, 0);
+    out.flush();
+    double t = seconds_since(start);
+    if (t < best)
+      best = t;
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  handle_flags(argc, argv);
+  if (optind >= argc) {
+    cerr << "usage: ast_bench file [rounds]\n";
+    exit(1);
+  }
+  int rounds = optind + 1 < argc ? atoi(argv[optind + 1]) : 5;
+  fin = fopen(argv[optind], "r");
+  if (fin == NULL) {
+    cerr << "Could not open input file " << argv[optind] << endl;
+    exit(1);
+  }
+  curr_filename = argv[optind];
+  curr_lineno = 1;
+  seal_yyparse();
+  fclose(fin);
+  if (omerrs != 0 || ast_root == NULL) {
+    cout << "syntax analyze failed. Please make sure syntax parser passed." << endl;
+    exit(-1);
+  }
+  clock_t start = clock();
+  ast_root->semant();
+  double check_time = seconds_since(start);
+  size_t class_bytes = ast_arena->bytes_used();
+
+  CompactAst ast;
+  start = clock();
+  ast_root->lower(ast);
+  double lower_time = seconds_since(start);
+
+  std::ostringstream class_out, compact_out;
+  {
+    DumpWriter class_writer(class_out), compact_writer(compact_out);
+    ast_root->dump_with_types(class_writer, 0);
+    ast.dump_with_types(compact_writer, 0);
+  }
+  if (class_out.str() != compact_out.str()) {
+    cerr << "error: compact dump differs from class dump\n";
+    exit(1);
+  }
+
+  std::ofstream null_stream("/dev/null");
+  DumpWriter null_out(null_stream);
+  double class_dump = best_class_dump(null_out, rounds);
+  double compact_dump = best_compact_dump(ast, null_out, rounds);
+
+  int mismatches = 0;
+  double recheck = 1e30;
+  for (int r = 0; r < rounds; r++) {
+    start = clock();
+    mismatches = ast.recheck_operator_types();
+    double t = seconds_since(start);
+    if (t < recheck)
+      recheck = t;
+  }
+
+  start = clock();
+  std::ostringstream binary_out;
+  write_binary_ast(ast, binary_out);
+  double binary_write = seconds_since(start);
+  std::string image_bytes = binary_out.str();
+  std::vector<unsigned int> image((image_bytes.size() + 3) / 4);
+  memcpy(image.data(), image_bytes.data(), image_bytes.size());
+
+  BinaryAst file;
+  start = clock();
+  if (!file.load((const char *) image.data(), image_bytes.size())) {
+    cerr << "error: cannot load binary AST: " << file.error() << "\n";
+    exit(1);
+  }
+  double binary_load = seconds_since(start);
+  start = clock();
+  Program rebuilt = file.rebuild();
+  double binary_rebuild = seconds_since(start);
+
+  std::ostringstream rebuilt_out;
+  {
+    DumpWriter rebuilt_writer(rebuilt_out);
+    rebuilt->dump_with_types(rebuilt_writer, 0);
+  }
+  if (class_out.str() != rebuilt_out.str()) {
+    cerr << "error: rebuilt binary AST dump differs from class dump\n";
+    exit(1);
+  }
+
+  int nodes = ast.size();
+  double mb = class_out.str().size() / 1e6;
+  cout << nodes << " nodes, " << mb << " MB of dump output\n";
+  cout << "  class AST:   " << class_bytes << " bytes, "
+       << (double) class_bytes / nodes << " bytes/node\n";
+  cout << "  compact AST: " << ast.bytes() << " bytes, "
+       << (double) ast.bytes() / nodes << " bytes/node\n";
+  cout << "  check:        " << check_time << " s\n";
+  cout << "  lower:        " << lower_time << " s\n";
+  cout << "  class dump:   " << class_dump << " s (" << mb / class_dump
+       << " MB/s)\n";
+  cout << "  compact dump: " << compact_dump << " s (" << mb / compact_dump
+       << " MB/s)\n";
+  cout << "  recheck:      " << recheck << " s ("
+       << nodes / recheck / 1e6 << " M nodes/s), "
+       << mismatches << " mismatches\n";
+  cout << "  binary:       " << image_bytes.size() << " bytes, write "
+       << binary_write << " s, load " << binary_load << " s, rebuild "
+       << binary_rebuild << " s\n";
+  return mismatches != 0;
+}
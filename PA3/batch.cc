@@ -0,0 +1,212 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  batch.cc
+//
+//  The batch driver (see batch.h).  Workers take the next file from an
+//  atomic counter, compile it with their diagnostics going to a string
+//  (begin_batch_file), and store the result in the file's slot.  The
+//  calling thread waits for the slots in order and writes each one out
+//  as soon as it and all the files before it are done.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "batch.h"
+#include "parse-context.h"
+#include "phase-report.h"
+#include "seal-stmt.h"
+#include "semant-diag.h"
+#include "stringtab.h"
+#include "utilities.h"
+
+extern int diagnostic_format;
+
+struct FileResult {
+  std::string out;      // what a single compile would write to cout
+  std::string diag;     // and to cerr
+  int status;           // and exit with
+  bool done;
+
+  FileResult() : status(0), done(false) { }
+};
+
+struct Batch {
+  std::vector<char *> &files;
+  bool mapped;
+  std::vector<FileResult> results;  // one per file
+  std::atomic<size_t> next;         // the next file to compile
+  std::mutex lock;                  // guards results
+  std::condition_variable finished; // a result is done
+
+  Batch(std::vector<char *> &f, bool m)
+    : files(f), mapped(m), results(f.size()), next(0) { }
+};
+
+void add_input(char *arg, std::vector<char *> &files)
+{
+  if (arg[0] != '@') {
+    files.push_back(arg);
+    return;
+  }
+  std::ifstream list(arg + 1);
+  if (!list) {
+    cerr << "Could not open response file " << arg + 1 << endl;
+    exit(1);
+  }
+  std::string name;
+  while (list >> name)
+    files.push_back(strdup(name.c_str()));
+}
+
+// Compile one file as semant-phase.cc does, writing the dump to out.
+// Returns the exit status.
+static int compile_file(char *filename, bool mapped, ostream &out)
+{
+  ParseContext input(filename, mapped);
+  if (!input.parse()) {
+    diagnostics() << "Could not open input file " << filename << endl;
+    return 1;
+  }
+  if (input.errors != 0 || input.ast_root == NULL) {
+    out << "syntax analyze failed. Please make sure syntax parser passed." << endl;
+    return -1;
+  }
+
+  // Checking and dumping flatten lists, which allocates: keep that in
+  // the file's own arena rather than the one shared by all threads.
+  Arena *saved_arena = ast_arena;
+  ast_arena = &input.arena;
+  int status = 0;
+  int errors;
+  {
+    PhaseTimer timer(PHASE_SEMANT);
+    errors = input.ast_root->check_program();
+  }
+  if (errors > 0) {
+    status = 1;
+  } else {
+    PhaseTimer timer(PHASE_DUMP);
+    DumpWriter dump(out);
+    input.ast_root->dump_with_types(dump, 0);
+    dump.flush();
+  }
+  ast_arena = saved_arena;
+  return status;
+}
+
+// Every line of text, prefixed with "filename: ".  With -D json the
+// line of semant's JSON object is left alone: it names its file, and a
+// prefix would make it invalid JSON.
+static std::string prefix_lines(char *filename, const std::string &text)
+{
+  std::string result;
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find('\n', start);
+    end = end == std::string::npos ? text.size() : end + 1;
+    if (diagnostic_format != DIAG_JSON || text[start] != '{') {
+      result += filename;
+      result += ": ";
+    }
+    result.append(text, start, end - start);
+    start = end;
+  }
+  if (!result.empty() && result[result.size() - 1] != '\n')
+    result += '\n';
+  return result;
+}
+
+static void work(Batch *batch)
+{
+  size_t i;
+  while ((i = batch->next++) < batch->files.size()) {
+    std::ostringstream out, diag;
+    int status;
+    begin_batch_file(diag);
+    try {
+      status = compile_file(batch->files[i], batch->mapped, out);
+    } catch (CompilationAborted &aborted) {
+      status = aborted.status;
+    }
+    end_batch_file();
+
+    std::string diag_text = prefix_lines(batch->files[i], diag.str());
+    std::lock_guard<std::mutex> hold(batch->lock);
+    FileResult &result = batch->results[i];
+    result.out = out.str();
+    result.diag.swap(diag_text);
+    result.status = status;
+    result.done = true;
+    batch->finished.notify_all();
+  }
+  merge_phase_report();
+}
+
+int compile_batch(std::vector<char *> &files, int jobs, bool mapped)
+{
+  if (jobs <= 0)
+    jobs = std::thread::hardware_concurrency();
+  if (jobs > (int) files.size())
+    jobs = files.size();
+  if (jobs < 1)
+    jobs = 1;
+
+  idtable.begin_shared();
+  inttable.begin_shared();
+  stringtable.begin_shared();
+  floattable.begin_shared();
+
+  Batch batch(files, mapped);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < jobs; t++)
+    workers.push_back(std::thread(work, &batch));
+
+  int failed = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    FileResult result;
+    {
+      std::unique_lock<std::mutex> hold(batch.lock);
+      while (!batch.results[i].done)
+        batch.finished.wait(hold);
+      result.out.swap(batch.results[i].out);
+      result.diag.swap(batch.results[i].diag);
+      result.status = batch.results[i].status;
+    }
+    cerr << result.diag;
+    cerr.flush();
+    cout << "==> " << files[i] << " <==\n" << result.out;
+    cout.flush();
+    if (result.status != 0)
+      failed++;
+  }
+
+  for (int t = 0; t < jobs; t++)
+    workers[t].join();
+  idtable.end_shared();
+  inttable.end_shared();
+  stringtable.end_shared();
+  floattable.end_shared();
+
+  if (phase_report != REPORT_NONE)
+    print_phase_report(cerr, phase_report == REPORT_JSON);
+  if (diagnostic_format == DIAG_JSON)
+    cerr << "{\"failed\": " << failed << ", \"files\": " << files.size()
+         << "}" << endl;
+  else if (failed > 0)
+    cerr << failed << " of " << files.size() << " files failed" << endl;
+  return failed > 0 ? 1 : 0;
+}
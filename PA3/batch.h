@@ -0,0 +1,46 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef BATCH_H
+#define BATCH_H
+//////////////////////////////////////////////////////////////////////
+//
+//  batch.h
+//
+//  Compiling many Seal files in one run.  Each file is parsed, checked
+//  and dumped on one of a pool of worker threads, exactly as semant
+//  does for a single file, but its output and diagnostics are kept
+//  apart from those of the other files and written out in the order
+//  the files were given, whatever order they finish in.
+//
+//     void add_input(char *arg, std::vector<char *> &files)
+//       appends arg to files or, if arg is @name, the whitespace
+//       separated file names read from the response file name.
+//
+//     int compile_batch(std::vector<char *> &files, int jobs, bool mapped)
+//       compiles files on jobs threads, hardware_concurrency if jobs
+//       is 0 or less (semant -j 0, or several files without -j).  For
+//       each file, in order, its diagnostics go to cerr, every line
+//       but the JSON object of -D json prefixed with "file: ", and a
+//       "==> file <==" line followed by its typed AST dump to cout.
+//       Then cerr gets how many files failed: a line if any did, or
+//       with -D json always, as {"failed": n, "files": m}.  Returns 0
+//       if every file compiled, 1 otherwise: the exit status of the
+//       run.
+//
+//  A lexical error, or too many syntax errors, ends only the file it
+//  is in (abort_compilation in utilities.h throws instead of exiting
+//  inside a batch).  The string tables are shared (stringtab.h) for
+//  the whole batch.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+void add_input(char *arg, std::vector<char *> &files);
+int compile_batch(std::vector<char *> &files, int jobs, bool mapped);
+
+#endif
@@ -0,0 +1,151 @@
+#!/bin/bash
+#
+# bench.sh: throughput of the lexer, the parser and the semantic checker
+# on Seal programs written by seal_gen, compared with a stored baseline.
+#
+# usage: bench.sh [-q] [-s] [-r rounds] [-t tolerance] [-b baseline]
+#
+#   -q   quick: a smaller set of inputs
+#   -s   save the results as the new baseline
+#   -r   rounds per measurement, of which the best counts (default 3)
+#   -t   percent by which throughput may fall below the baseline before
+#        it is reported as a regression (default 10)
+#   -b   the baseline file (default bench-baseline.txt)
+#
+# Stages, each run on every input:
+#   lex      lex_bench, which times this directory's lexer reading with fread
+#   lextest  ../PA1/lexer, if it has been built (it needs flex)
+#   parser   ../PA2/parser, if it has been built
+#   semant   ./semant: lex, parse, check and dump
+#
+# The "scale" inputs have the default shape and a growing number of
+# functions, so their rows are the scaling curve of each stage; the
+# others stress one dimension each.  Results are printed as MB/s and
+# written to bench-results.txt, one "input stage MB/s" line each.
+# The exit status is 1 if anything regressed.
+
+rounds=3
+tolerance=10
+baseline=bench-baseline.txt
+save=0
+quick=0
+while getopts "qsr:t:b:" opt; do
+    case $opt in
+    q) quick=1 ;;
+    s) save=1 ;;
+    r) rounds=$OPTARG ;;
+    t) tolerance=$OPTARG ;;
+    b) baseline=$OPTARG ;;
+    *) echo "usage: $0 [-q] [-s] [-r rounds] [-t tolerance] [-b baseline]"; exit 1 ;;
+    esac
+done
+
+cd "$(dirname "$0")"
+make -s semant lex_bench seal_gen || exit 1
+
+work=$(mktemp -d "${TMPDIR:-/tmp}/seal-bench.XXXXXX")
+trap 'rm -rf "$work"' EXIT
+
+# name and seal_gen options of each input.  -p keeps the programs within
+# what PA2's parser accepts, so that every stage can read every input.
+if [ $quick -eq 1 ]; then
+    inputs=(
+        "scale-25   -f 25"
+        "scale-50   -f 50"
+        "scale-100  -f 100"
+        "deep-expr  -f 20 -d 8"
+        "nested     -f 20 -n 4 -s 6"
+    )
+else
+    inputs=(
+        "scale-50   -f 50"
+        "scale-100  -f 100"
+        "scale-200  -f 200"
+        "scale-400  -f 400"
+        "scale-800  -f 800"
+        "deep-expr  -f 100 -d 8"
+        "nested     -f 100 -n 4 -s 6"
+        "strings    -f 200 -c 200 -l 80"
+        "literals   -f 200 -l 90"
+        "idents     -f 100 -i 512"
+    )
+fi
+
+# Best wall time, in seconds, of $rounds runs of a command.
+best_time() {
+    local best="" start end t
+    for ((r = 0; r < rounds; r++)); do
+        start=$(date +%s%N)
+        "$@" > /dev/null 2>&1
+        end=$(date +%s%N)
+        t=$(awk -v ns=$((end - start)) 'BEGIN { printf "%.6f", ns / 1e9 }')
+        if [ -z "$best" ] || awk -v a="$t" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+            best=$t
+        fi
+    done
+    echo "$best"
+}
+
+# Throughput of a stage on a file: the MB/s, or "-" if it cannot run.
+measure() {
+    local stage=$1 file=$2 seconds
+    case $stage in
+    lex)
+        seconds=$(./lex_bench "$file" "$rounds" | awk '/fread:/ { print $2 }') ;;
+    lextest)
+        [ -x ../PA1/lexer ] || { echo -; return; }
+        seconds=$(best_time ../PA1/lexer "$file") ;;
+    parser)
+        [ -x ../PA2/parser ] || { echo -; return; }
+        if ../PA2/parser "$file" 2>&1 | grep -q "syntax error"; then
+            echo -; return
+        fi
+        seconds=$(best_time ../PA2/parser "$file") ;;
+    semant)
+        ./semant "$file" > /dev/null 2>&1 || { echo -; return; }
+        seconds=$(best_time ./semant "$file") ;;
+    esac
+    awk -v b="$(stat -c %s "$file")" -v s="$seconds" \
+        'BEGIN { if (s > 0) printf "%.2f", b / 1e6 / s; else print "-" }'
+}
+
+stages="lex lextest parser semant"
+results=$work/results
+printf "%-12s %10s" input KB
+for stage in $stages; do printf " %10s" "$stage"; done
+printf "    (MB/s)\n"
+for spec in "${inputs[@]}"; do
+    set -- $spec
+    name=$1; shift
+    file=$work/$name.seal
+    ./seal_gen -p "$@" > "$file"
+    printf "%-12s %10d" "$name" $(( $(stat -c %s "$file") / 1024 ))
+    for stage in $stages; do
+        mbps=$(measure $stage "$file")
+        printf " %10s" "$mbps"
+        [ "$mbps" != "-" ] && echo "$name $stage $mbps" >> "$results"
+    done
+    printf "\n"
+done
+cp "$results" bench-results.txt
+
+status=0
+if [ -f "$baseline" ] && [ $save -eq 0 ]; then
+    echo
+    echo "against $baseline (tolerance $tolerance%):"
+    awk -v tol="$tolerance" '
+        NR == FNR { base[$1 " " $2] = $3; next }
+        ($1 " " $2) in base {
+            b = base[$1 " " $2]
+            change = ($3 - b) / b * 100
+            flag = change < -tol ? "  REGRESSION" : ""
+            printf "  %-12s %-8s %9.2f -> %9.2f MB/s %+7.1f%%%s\n", $1, $2, b, $3, change, flag
+            if (flag != "") bad = 1
+        }
+        END { exit bad }' "$baseline" "$results" || status=1
+fi
+if [ $save -eq 1 ]; then
+    cp "$results" "$baseline"
+    echo "saved the baseline in $baseline"
+fi
+exit $status
@@ -0,0 +1,553 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  binary-ast.cc
+//
+//  Writing and reading the binary typed-AST format of binary-ast.h.
+//  The writer copies the arrays of a CompactAst and the symbol tables
+//  into one image; the reader checks an image once, up front, so that
+//  the walks over it (and rebuild) can index the arrays freely.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <string>
+#include "seal-decl.h"
+#include "seal-stmt.h"
+#include "seal-expr.h"
+#include "binary-ast.h"
+
+extern thread_local int node_lineno; // line given to the next tree node made
+
+//
+// Writing
+//
+
+// Round n up to a multiple of 4.
+static unsigned int align4(unsigned int n)
+{
+  return (n + 3) & ~3u;
+}
+
+// The strings of table, each followed by a null, and where each starts.
+template <class Elem>
+static void collect_symbols(StringTable<Elem> &table,
+                            std::vector<unsigned int> &offsets,
+                            std::string &chars)
+{
+  for (int i = table.first(); table.more(i); i = table.next(i)) {
+    Elem *e = table.lookup(i);
+    offsets.push_back(chars.size());
+    chars.append(e->get_string(), e->get_len());
+    chars.push_back('\0');
+  }
+  offsets.push_back(chars.size());
+}
+
+// Place a section of count elements of size bytes at *end.
+static BinaryAstSection place(unsigned int &end, unsigned int count,
+                              unsigned int size)
+{
+  BinaryAstSection s;
+  s.offset = end;
+  s.count = count;
+  end = align4(end + count * size);
+  return s;
+}
+
+static void write_section(ostream &out, unsigned int &at,
+                          const BinaryAstSection &s, const void *data,
+                          unsigned int size)
+{
+  static const char zeros[4] = { 0, 0, 0, 0 };
+  out.write(zeros, s.offset - at);
+  out.write((const char *) data, s.count * size);
+  at = s.offset + s.count * size;
+}
+
+void write_binary_ast(CompactAst &ast, ostream &out)
+{
+  std::vector<unsigned int> offsets[NUM_SYMBOL_TABLES];
+  std::string chars[NUM_SYMBOL_TABLES];
+  collect_symbols(idtable, offsets[ID_TABLE], chars[ID_TABLE]);
+  collect_symbols(inttable, offsets[INT_TABLE], chars[INT_TABLE]);
+  collect_symbols(stringtable, offsets[STRING_TABLE], chars[STRING_TABLE]);
+  collect_symbols(floattable, offsets[FLOAT_TABLE], chars[FLOAT_TABLE]);
+
+  BinaryAstHeader h;
+  memset(&h, 0, sizeof(h));
+  h.magic = BINARY_AST_MAGIC;
+  h.version = BINARY_AST_VERSION;
+  h.root = ast.root;
+
+  unsigned int end = align4(sizeof(h));
+  unsigned int n = ast.size();
+  h.kind = place(end, n, sizeof(ast.kind[0]));
+  h.line = place(end, n, sizeof(ast.line[0]));
+  h.type = place(end, n, sizeof(ast.type[0]));
+  h.a = place(end, n, sizeof(ast.a[0]));
+  h.b = place(end, n, sizeof(ast.b[0]));
+  h.lists = place(end, ast.lists.size(), sizeof(ast.lists[0]));
+  for (int t = 0; t < NUM_SYMBOL_TABLES; t++) {
+    h.symbol_offsets[t] = place(end, offsets[t].size(), sizeof(unsigned int));
+    h.symbol_chars[t] = place(end, chars[t].size(), 1);
+  }
+  h.size = end;
+
+  unsigned int at = sizeof(h);
+  out.write((const char *) &h, sizeof(h));
+  write_section(out, at, h.kind, ast.kind.data(), sizeof(ast.kind[0]));
+  write_section(out, at, h.line, ast.line.data(), sizeof(ast.line[0]));
+  write_section(out, at, h.type, ast.type.data(), sizeof(ast.type[0]));
+  write_section(out, at, h.a, ast.a.data(), sizeof(ast.a[0]));
+  write_section(out, at, h.b, ast.b.data(), sizeof(ast.b[0]));
+  write_section(out, at, h.lists, ast.lists.data(), sizeof(ast.lists[0]));
+  for (int t = 0; t < NUM_SYMBOL_TABLES; t++) {
+    write_section(out, at, h.symbol_offsets[t], offsets[t].data(),
+                  sizeof(unsigned int));
+    write_section(out, at, h.symbol_chars[t], chars[t].data(), 1);
+  }
+  static const char zeros[4] = { 0, 0, 0, 0 };
+  out.write(zeros, h.size - at);
+}
+
+//
+// Reading
+//
+
+BinaryAst::BinaryAst()
+  : mapping(NULL), mapping_size(0), data(NULL), data_size(0),
+    reason(NULL), header(NULL), kind(NULL), line(NULL), type(NULL),
+    a(NULL), b(NULL), lists(NULL), root(NO_ID)
+{
+  for (int t = 0; t < NUM_SYMBOL_TABLES; t++) {
+    offsets[t] = NULL;
+    chars[t] = NULL;
+    symbol_count[t] = 0;
+  }
+}
+
+bool BinaryAst::fail(const char *why)
+{
+  reason = why;
+  header = NULL;
+  root = NO_ID;
+  return false;
+}
+
+void BinaryAst::unmap()
+{
+  if (mapping)
+    munmap(mapping, mapping_size);
+  mapping = NULL;
+  mapping_size = 0;
+}
+
+bool BinaryAst::open(const char *filename)
+{
+  unmap();
+  int fd = ::open(filename, O_RDONLY);
+  if (fd < 0)
+    return fail("cannot open file");
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return fail("cannot stat file");
+  }
+  if ((size_t) st.st_size < sizeof(BinaryAstHeader)) {
+    close(fd);
+    return fail("file is too short");
+  }
+  void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED)
+    return fail("cannot map file");
+  mapping = m;
+  mapping_size = st.st_size;
+  return load((const char *) m, st.st_size);
+}
+
+bool BinaryAst::load(const char *d, size_t size)
+{
+  data = d;
+  data_size = size;
+  header = NULL;
+  if (((size_t) d & 3) != 0)
+    return fail("image is not 4-byte aligned");
+  if (size < sizeof(BinaryAstHeader))
+    return fail("file is too short");
+  const BinaryAstHeader *h = (const BinaryAstHeader *) d;
+  if (h->magic != BINARY_AST_MAGIC)
+    return fail("not a binary AST, or written with another byte order");
+  if (h->version != BINARY_AST_VERSION)
+    return fail("unsupported version");
+  if (h->size != size)
+    return fail("size in header does not match the file");
+  header = h;
+  if (!check_sections() || !check_nodes())
+    return false;
+  reason = NULL;
+  return true;
+}
+
+// Does s fit in the image, with elements of size bytes?
+static bool fits(const BinaryAstSection &s, size_t size, size_t image)
+{
+  return (s.offset & 3) == 0 && s.offset <= image &&
+         (unsigned long long) s.count * size <= image - s.offset;
+}
+
+bool BinaryAst::check_sections()
+{
+  const BinaryAstHeader *h = header;
+  if (!fits(h->kind, 1, data_size) || !fits(h->line, 4, data_size) ||
+      !fits(h->type, 4, data_size) || !fits(h->a, 4, data_size) ||
+      !fits(h->b, 4, data_size) || !fits(h->lists, 4, data_size))
+    return fail("node section out of bounds");
+  unsigned int n = h->kind.count;
+  if (h->line.count != n || h->type.count != n || h->a.count != n ||
+      h->b.count != n)
+    return fail("node sections differ in length");
+
+  kind = (const unsigned char *) (data + h->kind.offset);
+  line = (const int *) (data + h->line.offset);
+  type = (const unsigned int *) (data + h->type.offset);
+  a = (const unsigned int *) (data + h->a.offset);
+  b = (const unsigned int *) (data + h->b.offset);
+  lists = (const NodeId *) (data + h->lists.offset);
+
+  for (int t = 0; t < NUM_SYMBOL_TABLES; t++) {
+    const BinaryAstSection &os = h->symbol_offsets[t];
+    const BinaryAstSection &cs = h->symbol_chars[t];
+    if (!fits(os, 4, data_size) || !fits(cs, 1, data_size) || os.count == 0)
+      return fail("symbol section out of bounds");
+    offsets[t] = (const unsigned int *) (data + os.offset);
+    chars[t] = data + cs.offset;
+    symbol_count[t] = os.count - 1;
+    if (offsets[t][0] != 0 || offsets[t][os.count - 1] != cs.count)
+      return fail("symbol offsets do not cover the characters");
+    for (unsigned int i = 0; i < symbol_count[t]; i++)
+      if (offsets[t][i + 1] <= offsets[t][i] || offsets[t][i + 1] > cs.count ||
+          chars[t][offsets[t][i + 1] - 1] != '\0')
+        return fail("symbol is not null terminated");
+  }
+  return true;
+}
+
+static bool is_decl(int k)
+{
+  return k == K_VARIABLE_DECL || k == K_CALL_DECL;
+}
+
+// Kinds that are an Expr_class.  Actuals only appear in actual lists.
+static bool is_expr(int k)
+{
+  return k >= K_ASSIGN && k <= K_NO_EXPR && k != K_ACTUAL;
+}
+
+static bool is_stmt(int k)
+{
+  return (k >= K_STMT_BLOCK && k <= K_BREAK) || is_expr(k);
+}
+
+static bool is_block(int k)           { return k == K_STMT_BLOCK; }
+static bool is_variable(int k)        { return k == K_VARIABLE; }
+static bool is_variable_decl(int k)   { return k == K_VARIABLE_DECL; }
+static bool is_actual(int k)          { return k == K_ACTUAL; }
+
+// Is c a child of node id: an earlier node of a kind accepted by ok?
+bool BinaryAst::child(unsigned int c, NodeId id, bool (*ok)(int))
+{
+  return c < id && ok(kind[c]);
+}
+
+// Is c a list operand of node id whose elements are accepted by ok?
+bool BinaryAst::list_of(unsigned int c, NodeId id, bool (*ok)(int))
+{
+  unsigned int nlists = header->lists.count;
+  if (c >= id || kind[c] != K_LIST || a[c] > nlists || b[c] > nlists - a[c])
+    return false;
+  for (unsigned int i = a[c]; i < a[c] + b[c]; i++)
+    if (lists[i] >= c || !ok(kind[lists[i]]))
+      return false;
+  return true;
+}
+
+// Does node id have count operands in the lists array?
+bool BinaryAst::operands(NodeId id, unsigned int count)
+{
+  unsigned int nlists = header->lists.count;
+  return a[id] <= nlists && count <= nlists - a[id];
+}
+
+bool BinaryAst::check_nodes()
+{
+  const unsigned int ids = symbol_count[ID_TABLE];
+  const unsigned int n = size();
+
+  for (NodeId id = 0; id < n; id++) {
+    if (type[id] != NO_ID && type[id] >= ids)
+      return fail("type symbol out of range");
+    const NodeId *ops = lists + a[id];
+    bool ok = true;
+    switch (kind[id]) {
+    case K_PROGRAM:
+      ok = list_of(a[id], id, is_decl);
+      break;
+    case K_VARIABLE:
+      ok = a[id] < ids && b[id] < ids;
+      break;
+    case K_VARIABLE_DECL:
+      ok = child(a[id], id, is_variable);
+      break;
+    case K_CALL_DECL:
+      ok = operands(id, 4) && ops[0] < ids &&
+           list_of(ops[1], id, is_variable) && ops[2] < ids &&
+           child(ops[3], id, is_block);
+      break;
+    case K_STMT_BLOCK:
+      ok = list_of(a[id], id, is_variable_decl) &&
+           list_of(b[id], id, is_stmt);
+      break;
+    case K_IF:
+      ok = operands(id, 3) && child(ops[0], id, is_expr) &&
+           child(ops[1], id, is_block) &&
+           child(ops[2], id, is_block);
+      break;
+    case K_WHILE:
+      ok = child(a[id], id, is_expr) &&
+           child(b[id], id, is_block);
+      break;
+    case K_FOR:
+      ok = operands(id, 4) && child(ops[0], id, is_expr) &&
+           child(ops[1], id, is_expr) && child(ops[2], id, is_expr) &&
+           child(ops[3], id, is_block);
+      break;
+    case K_RETURN:
+      ok = child(a[id], id, is_expr);
+      break;
+    case K_CONTINUE:
+    case K_BREAK:
+    case K_NO_EXPR:
+    case K_CONST_BOOL:
+      break;
+    case K_ASSIGN:
+      ok = a[id] < ids && child(b[id], id, is_expr);
+      break;
+    case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+    case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+    case K_AND: case K_OR: case K_XOR: case K_BITAND: case K_BITOR:
+      ok = child(a[id], id, is_expr) && child(b[id], id, is_expr);
+      break;
+    case K_NEG: case K_NOT: case K_BITNOT:
+      ok = child(a[id], id, is_expr);
+      break;
+    case K_CONST_INT:
+      ok = a[id] < symbol_count[INT_TABLE];
+      break;
+    case K_CONST_STRING:
+      ok = a[id] < symbol_count[STRING_TABLE];
+      break;
+    case K_CONST_FLOAT:
+      ok = a[id] < symbol_count[FLOAT_TABLE];
+      break;
+    case K_OBJECT:
+      ok = a[id] < ids;
+      break;
+    case K_CALL:
+      ok = a[id] < ids && list_of(b[id], id, is_actual);
+      break;
+    case K_ACTUAL:
+      ok = child(a[id], id, is_expr);
+      break;
+    case K_LIST:
+      // checked by the node that owns the list
+      break;
+    default:
+      return fail("unknown node kind");
+    }
+    if (!ok)
+      return fail("node operand out of range or of the wrong kind");
+  }
+
+  if (header->root >= n || kind[header->root] != K_PROGRAM)
+    return fail("root is not a program node");
+  root = header->root;
+  return true;
+}
+
+//
+// Rebuilding the class AST.  Nodes are made in id order, which is
+// post-order, so the children of a node are always ready before it.
+// Lists are made by the node that owns them, since only the owner
+// knows the type of their elements.
+//
+
+class Rebuilder {
+private:
+  const BinaryAst &f;
+  std::vector<tree_node *> nodes;
+  std::vector<Symbol> symbols[NUM_SYMBOL_TABLES];
+
+  template <class Elem>
+  void add_symbols(SymbolTableId t, StringTable<Elem> &table)
+  {
+    symbols[t].resize(f.symbols(t));
+    for (unsigned int i = 0; i < f.symbols(t); i++)
+      symbols[t][i] = table.add_string((char *) f.symbol(t, i),
+                                       f.symbol_len(t, i));
+  }
+
+  Symbol id_symbol(unsigned int i)
+  {
+    return i == NO_ID ? (Symbol) NULL : symbols[ID_TABLE][i];
+  }
+
+  template <class T> T node(NodeId id) { return (T) nodes[id]; }
+
+  Expr expr(NodeId id) { return node<Expr>(id); }
+
+  template <class Elem> list_node<Elem> *list(NodeId l)
+  {
+    int len = f.b[l];
+    count_alloc(len * sizeof(Elem));
+    Elem *elems = (Elem *) ast_arena->alloc(len * sizeof(Elem),
+                                            alignof(Elem));
+    for (int i = 0; i < len; i++)
+      elems[i] = node<Elem>(f.lists[f.a[l] + i]);
+    node_lineno = f.line[l];
+    return new flat_list_node<Elem>(elems, len);
+  }
+
+  tree_node *make(NodeId id);
+
+public:
+  Rebuilder(const BinaryAst &file) : f(file), nodes(file.size(), NULL)
+  {
+    add_symbols(ID_TABLE, idtable);
+    add_symbols(INT_TABLE, inttable);
+    add_symbols(STRING_TABLE, stringtable);
+    add_symbols(FLOAT_TABLE, floattable);
+  }
+
+  Program run()
+  {
+    int saved_lineno = node_lineno;
+    for (NodeId id = 0; id < f.size(); id++) {
+      if (f.kind[id] == K_LIST)
+        continue;
+      tree_node *t = make(id);
+      if (is_expr(f.kind[id]) || f.kind[id] == K_ACTUAL)
+        ((Expr) t)->setType(id_symbol(f.type[id]));
+      nodes[id] = t;
+    }
+    node_lineno = saved_lineno;
+    return node<Program>(f.root);
+  }
+};
+
+tree_node *Rebuilder::make(NodeId id)
+{
+  const NodeId *ops = f.lists + f.a[id];
+  NodeId x = f.a[id], y = f.b[id];
+
+  // The lists of a node are made before it, and take their own lines.
+  switch (f.kind[id]) {
+  case K_PROGRAM: {
+    Decls decls = list<Decl>(x);
+    node_lineno = f.line[id];
+    return program(decls);
+  }
+  case K_CALL_DECL: {
+    Variables params = list<Variable>(ops[1]);
+    node_lineno = f.line[id];
+    return callDecl(id_symbol(ops[0]), params, id_symbol(ops[2]),
+                    node<StmtBlock>(ops[3]));
+  }
+  case K_STMT_BLOCK: {
+    VariableDecls vars = list<VariableDecl>(x);
+    Stmts stmts = list<Stmt>(y);
+    node_lineno = f.line[id];
+    return stmtBlock(vars, stmts);
+  }
+  case K_CALL: {
+    Actuals actuals = list<Actual>(y);
+    node_lineno = f.line[id];
+    return call(id_symbol(x), actuals);
+  }
+  }
+
+  node_lineno = f.line[id];
+  switch (f.kind[id]) {
+  case K_VARIABLE:
+    return variable(id_symbol(x), id_symbol(y));
+  case K_VARIABLE_DECL:
+    return variableDecl(node<Variable>(x));
+  case K_IF:
+    return ifstmt(expr(ops[0]), node<StmtBlock>(ops[1]),
+                  node<StmtBlock>(ops[2]));
+  case K_WHILE:
+    return whilestmt(expr(x), node<StmtBlock>(y));
+  case K_FOR:
+    return forstmt(expr(ops[0]), expr(ops[1]), expr(ops[2]),
+                   node<StmtBlock>(ops[3]));
+  case K_RETURN:
+    return returnstmt(expr(x));
+  case K_CONTINUE:
+    return continuestmt();
+  case K_BREAK:
+    return breakstmt();
+  case K_ASSIGN:
+    return assign(id_symbol(x), expr(y));
+  case K_ADD:     return add(expr(x), expr(y));
+  case K_MINUS:   return minus(expr(x), expr(y));
+  case K_MULTI:   return multi(expr(x), expr(y));
+  case K_DIVIDE:  return divide(expr(x), expr(y));
+  case K_MOD:     return mod(expr(x), expr(y));
+  case K_LT:      return lt(expr(x), expr(y));
+  case K_LE:      return le(expr(x), expr(y));
+  case K_EQU:     return equ(expr(x), expr(y));
+  case K_NEQ:     return neq(expr(x), expr(y));
+  case K_GE:      return ge(expr(x), expr(y));
+  case K_GT:      return gt(expr(x), expr(y));
+  case K_AND:     return and_(expr(x), expr(y));
+  case K_OR:      return or_(expr(x), expr(y));
+  case K_XOR:     return xor_(expr(x), expr(y));
+  case K_BITAND:  return bitand_(expr(x), expr(y));
+  case K_BITOR:   return bitor_(expr(x), expr(y));
+  case K_NEG:     return neg(expr(x));
+  case K_NOT:     return not_(expr(x));
+  case K_BITNOT:  return bitnot(expr(x));
+  case K_CONST_INT:
+    return const_int(symbols[INT_TABLE][x]);
+  case K_CONST_STRING:
+    return const_string(symbols[STRING_TABLE][x]);
+  case K_CONST_FLOAT:
+    return const_float(symbols[FLOAT_TABLE][x]);
+  case K_CONST_BOOL:
+    return const_bool(x);
+  case K_OBJECT:
+    return object(id_symbol(x));
+  case K_ACTUAL:
+    return actual(expr(x));
+  default:
+    return no_expr();
+  }
+}
+
+Program BinaryAst::rebuild()
+{
+  if (!header)
+    return NULL;
+  return Rebuilder(*this).run();
+}
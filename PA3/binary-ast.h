@@ -0,0 +1,143 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef BINARY_AST_H
+#define BINARY_AST_H
+//////////////////////////////////////////////////////////////////////
+//
+//  binary-ast.h
+//
+//  A binary file format for the typed AST, so that tools downstream
+//  of semant can read the tree without parsing the text dump.  The
+//  file is the arrays of a CompactAst (see compact-ast.h) followed by
+//  the symbols they refer to, and is laid out to be used in place: a
+//  reader maps it and reads the arrays straight from the mapping.
+//
+//  All fields are 32-bit words in the byte order of the writer, except
+//  the kind array, which has one byte per node.  The file starts with
+//  a BinaryAstHeader; every section is a (offset, count) pair giving
+//  its position in bytes from the start of the file and its number of
+//  elements.  Sections start on a 4-byte boundary.
+//
+//     kind, line, type, a, b, lists    the CompactAst arrays
+//     symbol_offsets[t], symbol_chars[t]
+//                                      symbol table t: symbol i is the
+//                                      null terminated string at
+//                                      chars + offsets[i]; there are
+//                                      count - 1 symbols
+//
+//  The tables are ID_TABLE, INT_TABLE, STRING_TABLE and FLOAT_TABLE.
+//  Symbol ids in the arrays are indices into them: type[id] always
+//  refers to ID_TABLE, and so do name operands; the value of a
+//  K_CONST_INT, K_CONST_STRING or K_CONST_FLOAT refers to the table of
+//  its kind.
+//
+//     void write_binary_ast(CompactAst &ast, ostream &out)
+//       writes ast, and the current contents of idtable, inttable,
+//       stringtable and floattable, to out.
+//
+//  BinaryAst reads a file:
+//
+//     bool open(const char *filename)
+//       maps the file.  Returns false, with the reason in error(), if
+//       the file cannot be read or is not a well-formed binary AST.
+//     bool load(const char *data, size_t size)
+//       the same for an image that is already in memory.  data must
+//       stay valid, and 4-byte aligned, while the BinaryAst is used.
+//
+//  Once open or load succeeds the file has been checked completely:
+//  every operand is in range and every child has a smaller id than its
+//  parent.  The arrays can then be walked directly, without copying:
+//
+//     for (NodeId id = 0; id < f.size(); id++)
+//       if (f.kind[id] == K_CALL)
+//         cout << f.symbol(ID_TABLE, f.a[id]) << "\n";
+//
+//     Program rebuild()
+//       builds the class AST again, with line numbers and types, and
+//       adds the symbols to idtable, inttable, stringtable and
+//       floattable.  The nodes are allocated from ast_arena.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include "seal-io.h"
+#include "compact-ast.h"
+
+const unsigned int BINARY_AST_MAGIC = 0x54534153;   // "SAST"
+const unsigned int BINARY_AST_VERSION = 1;
+
+enum SymbolTableId {
+  ID_TABLE, INT_TABLE, STRING_TABLE, FLOAT_TABLE, NUM_SYMBOL_TABLES
+};
+
+struct BinaryAstSection {
+  unsigned int offset;
+  unsigned int count;
+};
+
+struct BinaryAstHeader {
+  unsigned int magic;
+  unsigned int version;
+  unsigned int size;          // of the whole file, in bytes
+  NodeId root;
+  BinaryAstSection kind, line, type, a, b, lists;
+  BinaryAstSection symbol_offsets[NUM_SYMBOL_TABLES];
+  BinaryAstSection symbol_chars[NUM_SYMBOL_TABLES];
+};
+
+void write_binary_ast(CompactAst &ast, ostream &out);
+
+class BinaryAst {
+private:
+  void *mapping;              // set if the file was mapped by open()
+  size_t mapping_size;
+  const char *data;
+  size_t data_size;
+  const char *reason;         // why open or load failed
+  const unsigned int *offsets[NUM_SYMBOL_TABLES];
+  const char *chars[NUM_SYMBOL_TABLES];
+  unsigned int symbol_count[NUM_SYMBOL_TABLES];
+
+  BinaryAst(const BinaryAst &);             // not copyable
+  BinaryAst &operator =(const BinaryAst &);
+
+  bool fail(const char *why);
+  void unmap();
+  bool check_sections();
+  bool check_nodes();
+  bool child(unsigned int c, NodeId id, bool (*ok)(int));
+  bool list_of(unsigned int c, NodeId id, bool (*ok)(int));
+  bool operands(NodeId id, unsigned int count);
+
+public:
+  const BinaryAstHeader *header;
+  const unsigned char *kind;
+  const int *line;
+  const unsigned int *type;
+  const unsigned int *a;
+  const unsigned int *b;
+  const NodeId *lists;
+  NodeId root;
+
+  BinaryAst();
+  ~BinaryAst() { unmap(); }
+
+  bool open(const char *filename);
+  bool load(const char *data, size_t size);
+  const char *error() const { return reason; }
+
+  unsigned int size() const { return header ? header->kind.count : 0; }
+  unsigned int symbols(SymbolTableId t) const { return symbol_count[t]; }
+  const char *symbol(SymbolTableId t, unsigned int i) const
+    { return chars[t] + offsets[t][i]; }
+  int symbol_len(SymbolTableId t, unsigned int i) const
+    { return offsets[t][i + 1] - offsets[t][i] - 1; }
+
+  Program rebuild();
+};
+
+#endif
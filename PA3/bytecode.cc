@@ -0,0 +1,582 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  bytecode.cc
+//
+//  Compiling a checked CompactAst into bytecode (see bytecode.h).  The
+//  compiler is a switch on kind[id], like the other compact passes.
+//  Registers are given out like a stack: a block's variables above
+//  those of the blocks around it, and a statement's temporaries above
+//  all of those, released when the statement ends.  Arguments of a
+//  call are evaluated into the registers at the top, which become the
+//  bottom of the callee's window.
+//
+//  semant types everything but the arguments of printf after the
+//  format, so the compiler works out the types of those itself with
+//  type_of, and reports the errors in them that semant lets through.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <unordered_map>
+#include "bytecode.h"
+#include "utilities.h"
+
+const int MAX_REGISTERS = 0xffff;
+
+class BytecodeCompiler {
+private:
+  CompactAst &ast;
+  Bytecode &bc;
+  unsigned int Int, Float, Bool, String, printf_name;   // idtable indices
+
+  std::unordered_map<unsigned int, int> functions;      // name -> index
+  std::vector<unsigned int> returns;                    // by index
+  std::unordered_map<unsigned long, unsigned int> constants;
+  std::unordered_map<std::string, unsigned int> print_types;
+
+  // the function being compiled
+  BytecodeFunction *current;
+  struct Binding {
+    unsigned int name;
+    int reg;
+    unsigned int type;
+  };
+  std::vector<Binding> scope;         // variables in scope, innermost last
+  std::vector<bool> is_variable;      // by register
+  std::vector<bool> effects;          // by node: it calls or assigns
+  int next_reg, max_reg;
+  struct Loop {
+    std::vector<size_t> breaks, continues;   // jumps to patch
+  };
+  std::vector<Loop> loops;
+  int line;
+
+  NodeId op(NodeId id, int i) { return ast.lists[ast.a[id] + i]; }
+  int length(NodeId list) { return ast.b[list]; }
+  NodeId element(NodeId list, int i) { return ast.lists[ast.a[list] + i]; }
+
+  size_t emit(Opcode o, int a = 0, int b = 0, int c = 0);
+  size_t emit_wide(Opcode o, int a, unsigned int bc);
+  void patch(size_t at, size_t target);
+  int temp();
+  void release(int mark);
+  void error(const char *message);
+  int bind(unsigned int name, unsigned int type);
+  const Binding &lookup(unsigned int name);
+  unsigned int type_of(NodeId id);
+  unsigned int constant(NodeId id);
+
+  int expr(NodeId id, int dst);
+  int operand(NodeId id, bool as_float);
+  int left_operand(int l, NodeId right);
+  void find_effects();
+  int call(NodeId id);
+  void stmt(NodeId id);
+  void block(NodeId id);
+  void loop_end(size_t continue_at, size_t break_at);
+  void function(NodeId decl);
+
+public:
+  BytecodeCompiler(CompactAst &a, Bytecode &b);
+  void program();
+};
+
+BytecodeCompiler::BytecodeCompiler(CompactAst &a, Bytecode &b)
+  : ast(a), bc(b), current(NULL), next_reg(0), max_reg(0), line(0)
+{
+  Int = symbol_id(idtable.lookup_string("Int"));
+  Float = symbol_id(idtable.lookup_string("Float"));
+  Bool = symbol_id(idtable.lookup_string("Bool"));
+  String = symbol_id(idtable.lookup_string("String"));
+  printf_name = symbol_id(idtable.lookup_string("printf"));
+}
+
+size_t BytecodeCompiler::emit(Opcode o, int a, int b, int c)
+{
+  Instr i = { (unsigned short) o, (unsigned short) a, (unsigned short) b,
+              (unsigned short) c };
+  bc.code.push_back(i);
+  bc.lines.push_back(line);
+  return bc.code.size() - 1;
+}
+
+size_t BytecodeCompiler::emit_wide(Opcode o, int a, unsigned int x)
+{
+  return emit(o, a, x & 0xffff, x >> 16);
+}
+
+void BytecodeCompiler::patch(size_t at, size_t target)
+{
+  bc.code[at].b = target & 0xffff;
+  bc.code[at].c = target >> 16;
+}
+
+int BytecodeCompiler::temp()
+{
+  if (next_reg >= MAX_REGISTERS)
+    fatal_error("bytecode: too many registers in one function\n");
+  int r = next_reg++;
+  if (next_reg > max_reg)
+    max_reg = next_reg;
+  if ((int) is_variable.size() < next_reg)
+    is_variable.resize(next_reg);
+  is_variable[r] = false;
+  return r;
+}
+
+void BytecodeCompiler::error(const char *message)
+{
+  diagnostics() << line << ": " << message << "\n";
+  abort_compilation(1);
+}
+
+// Free the registers from mark up, which no longer hold anything.
+// Temporaries only live within a statement, so none is live here.
+void BytecodeCompiler::release(int mark)
+{
+  next_reg = mark;
+  if (bc.boundaries.empty() || bc.boundaries.back() != bc.code.size())
+    bc.boundaries.push_back(bc.code.size());
+}
+
+int BytecodeCompiler::bind(unsigned int name, unsigned int type)
+{
+  int r = temp();
+  is_variable[r] = true;
+  Binding b = { name, r, type };
+  scope.push_back(b);
+  current->variables.push_back(r);
+  return r;
+}
+
+const BytecodeCompiler::Binding &BytecodeCompiler::lookup(unsigned int name)
+{
+  for (size_t i = scope.size(); i > 0; i--)
+    if (scope[i - 1].name == name)
+      return scope[i - 1];
+  error("an argument of printf uses an undefined variable");
+  return scope[0];
+}
+
+// The type of the expression id: the one semant gave it, or for the
+// unchecked arguments of printf, the one it would have given it.
+unsigned int BytecodeCompiler::type_of(NodeId id)
+{
+  unsigned int t = ast.type[id];
+  if (t == Int || t == Float || t == Bool || t == String)
+    return t;
+  switch (ast.kind[id]) {
+  case K_CONST_INT: return Int;
+  case K_CONST_FLOAT: return Float;
+  case K_CONST_STRING: return String;
+  case K_CONST_BOOL: return Bool;
+  case K_OBJECT: case K_ASSIGN: return lookup(ast.a[id]).type;
+  case K_ACTUAL: return type_of(ast.a[id]);
+  case K_CALL:
+    if (functions.count(ast.a[id]) == 0)
+      return NO_ID;
+    return returns[functions[ast.a[id]]];
+  case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+    return type_of(ast.a[id]) == Float || type_of(ast.b[id]) == Float
+           ? Float : Int;
+  case K_XOR: case K_BITAND: case K_BITOR: case K_NEG: case K_BITNOT:
+    return type_of(ast.a[id]);
+  case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+  case K_AND: case K_OR: case K_NOT:
+    return Bool;
+  default:
+    return NO_ID;
+  }
+}
+
+// The index in bc.constants of the value of a K_CONST_* node.
+unsigned int BytecodeCompiler::constant(NodeId id)
+{
+  unsigned long key = (unsigned long) ast.kind[id] << 32 | ast.a[id];
+  std::unordered_map<unsigned long, unsigned int>::iterator it =
+    constants.find(key);
+  if (it != constants.end())
+    return it->second;
+  Value v;
+  switch (ast.kind[id]) {
+  case K_CONST_INT:
+    v.i = strtol(inttable.lookup(ast.a[id])->get_string(), NULL, 10);
+    break;
+  case K_CONST_FLOAT:
+    v.f = strtod(floattable.lookup(ast.a[id])->get_string(), NULL);
+    break;
+  case K_CONST_STRING:
+    v.s = stringtable.lookup(ast.a[id])->get_string();
+    break;
+  default:
+    v.i = ast.a[id] != 0;
+    break;
+  }
+  bc.constants.push_back(v);
+  bc.constant_types.push_back(ast.kind[id] == K_CONST_FLOAT ? 'f'
+                              : ast.kind[id] == K_CONST_STRING ? 's' : 'i');
+  constants[key] = bc.constants.size() - 1;
+  return bc.constants.size() - 1;
+}
+
+// An operand of an arithmetic or comparison operator, converted to
+// Float if the operator works on Floats.
+int BytecodeCompiler::operand(NodeId id, bool as_float)
+{
+  int r = expr(id, -1);
+  if (as_float && type_of(id) == Int) {
+    int t = temp();
+    emit(OP_I2F, t, r);
+    return t;
+  }
+  return r;
+}
+
+// l, the register of an evaluated left operand, or a copy of it if l is
+// a variable that evaluating right may assign, so that the operator
+// sees the value from before right, as in left to right order.
+int BytecodeCompiler::left_operand(int l, NodeId right)
+{
+  if (!is_variable[l] || !effects[right])
+    return l;
+  int t = temp();
+  emit(OP_MOV, t, l);
+  return t;
+}
+
+// Evaluate the arguments into the registers at the top and call.
+// Returns the register with the result.
+int BytecodeCompiler::call(NodeId id)
+{
+  NodeId args = ast.b[id];
+  int n = length(args);
+  int base = next_reg;
+  for (int i = 0; i < (n > 0 ? n : 1); i++)
+    temp();
+  for (int i = 0; i < n; i++)
+    expr(ast.a[element(args, i)], base + i);
+
+  if (ast.a[id] == printf_name) {
+    std::string types;
+    for (int i = 0; i < n; i++) {
+      unsigned int t = type_of(element(args, i));
+      types += t == Float ? 'f' : t == String ? 's' : t == Bool ? 'b' : 'i';
+    }
+    std::unordered_map<std::string, unsigned int>::iterator it =
+      print_types.find(types);
+    if (it == print_types.end()) {
+      if (bc.print_types.size() > 0xffff)
+        fatal_error("bytecode: too many kinds of printf call\n");
+      it = print_types.insert(std::make_pair(types,
+                                             bc.print_types.size())).first;
+      bc.print_types.push_back(types);
+    }
+    emit(OP_PRINTF, base, n, it->second);
+  } else {
+    if (functions.count(ast.a[id]) == 0)
+      error("an argument of printf calls an undefined function");
+    int f = functions[ast.a[id]];
+    if (n != bc.functions[f].params)
+      error("an argument of printf calls a function with the wrong "
+            "number of arguments");
+    emit_wide(OP_CALL, base, f);
+  }
+  return base;
+}
+
+// Compile the expression id.  If dst is a register the value is left
+// there; if it is -1 it is left wherever is cheapest.  Returns the
+// register holding the value.
+int BytecodeCompiler::expr(NodeId id, int dst)
+{
+  static const Opcode int_ops[] = { OP_ADD_I, OP_SUB_I, OP_MUL_I, OP_DIV_I,
+                                    OP_MOD_I };
+  static const Opcode float_ops[] = { OP_ADD_F, OP_SUB_F, OP_MUL_F,
+                                      OP_DIV_F, OP_MOD_F };
+  // K_LT, K_LE, K_EQU, K_NEQ, K_GE, K_GT
+  static const Opcode int_compares[] = { OP_LT_I, OP_LE_I, OP_EQ_I, OP_NE_I,
+                                         OP_GE_I, OP_GT_I };
+  static const Opcode float_compares[] = { OP_LT_F, OP_LE_F, OP_EQ_F,
+                                           OP_NE_F, OP_GE_F, OP_GT_F };
+  int kind = ast.kind[id];
+  int saved_line = line;
+  line = ast.line[id];
+  int l, r, result;
+
+  switch (kind) {
+  case K_OBJECT:
+  case K_ASSIGN:
+    r = lookup(ast.a[id]).reg;
+    if (kind == K_ASSIGN)
+      expr(ast.b[id], r);
+    if (dst >= 0 && dst != r)
+      emit(OP_MOV, dst, r);
+    result = dst >= 0 ? dst : r;
+    break;
+  case K_ACTUAL:
+    result = expr(ast.a[id], dst);
+    break;
+  case K_CALL:
+    r = call(id);
+    if (dst >= 0 && dst != r)
+      emit(OP_MOV, dst, r);
+    result = dst >= 0 ? dst : r;
+    break;
+  case K_AND:
+  case K_OR:
+    // The left operand is evaluated into a temporary unless dst is
+    // one, because the right one may read the variable dst.
+    result = dst >= 0 && !is_variable[dst] ? dst : temp();
+    {
+      expr(ast.a[id], result);
+      size_t skip = emit_wide(kind == K_AND ? OP_JF : OP_JT, result, 0);
+      expr(ast.b[id], result);
+      patch(skip, bc.code.size());
+    }
+    if (dst >= 0 && dst != result) {
+      emit(OP_MOV, dst, result);
+      result = dst;
+    }
+    break;
+  case K_NO_EXPR:
+    result = dst;
+    break;
+  default:
+    result = dst >= 0 ? dst : temp();
+    switch (kind) {
+    case K_CONST_INT: case K_CONST_FLOAT: case K_CONST_STRING:
+    case K_CONST_BOOL:
+      emit_wide(OP_LOADK, result, constant(id));
+      break;
+    case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD: {
+      bool f = type_of(id) == Float;
+      l = left_operand(operand(ast.a[id], f), ast.b[id]);
+      r = operand(ast.b[id], f);
+      emit((f ? float_ops : int_ops)[kind - K_ADD], result, l, r);
+      break;
+    }
+    case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT: {
+      bool f = type_of(ast.a[id]) == Float || type_of(ast.b[id]) == Float;
+      l = left_operand(operand(ast.a[id], f), ast.b[id]);
+      r = operand(ast.b[id], f);
+      emit((f ? float_compares : int_compares)[kind - K_LT], result, l, r);
+      break;
+    }
+    case K_XOR: case K_BITAND: case K_BITOR:
+      l = left_operand(expr(ast.a[id], -1), ast.b[id]);
+      r = expr(ast.b[id], -1);
+      emit(kind == K_XOR ? OP_XOR : kind == K_BITAND ? OP_AND : OP_OR,
+           result, l, r);
+      break;
+    case K_NEG:
+      l = expr(ast.a[id], -1);
+      emit(type_of(id) == Float ? OP_NEG_F : OP_NEG_I, result, l);
+      break;
+    case K_NOT:
+    case K_BITNOT:
+      l = expr(ast.a[id], -1);
+      emit(kind == K_NOT ? OP_NOT : OP_BITNOT, result, l);
+      break;
+    default:
+      fatal_error("bytecode: unexpected node in an expression\n");
+    }
+    break;
+  }
+  line = saved_line;
+  return result;
+}
+
+void BytecodeCompiler::block(NodeId id)
+{
+  size_t scope_mark = scope.size();
+  int reg_mark = next_reg;
+  NodeId decls = ast.a[id];
+  for (int i = 0; i < length(decls); i++) {
+    NodeId var = ast.a[element(decls, i)];
+    bind(ast.a[var], ast.b[var]);
+  }
+  NodeId stmts = ast.b[id];
+  for (int i = 0; i < length(stmts); i++)
+    stmt(element(stmts, i));
+  scope.resize(scope_mark);
+  release(reg_mark);
+}
+
+// Point the breaks and continues of the innermost loop at their targets.
+void BytecodeCompiler::loop_end(size_t continue_at, size_t break_at)
+{
+  Loop &loop = loops.back();
+  for (size_t i = 0; i < loop.continues.size(); i++)
+    patch(loop.continues[i], continue_at);
+  for (size_t i = 0; i < loop.breaks.size(); i++)
+    patch(loop.breaks[i], break_at);
+  loops.pop_back();
+}
+
+void BytecodeCompiler::stmt(NodeId id)
+{
+  int reg_mark = next_reg;
+  line = ast.line[id];
+  switch (ast.kind[id]) {
+  case K_STMT_BLOCK:
+    block(id);
+    break;
+  case K_IF: {
+    int c = expr(op(id, 0), -1);
+    size_t to_else = emit_wide(OP_JF, c, 0);
+    block(op(id, 1));
+    NodeId else_block = op(id, 2);
+    if (length(ast.b[else_block]) > 0) {
+      size_t to_end = emit_wide(OP_JMP, 0, 0);
+      patch(to_else, bc.code.size());
+      block(else_block);
+      patch(to_end, bc.code.size());
+    } else {
+      patch(to_else, bc.code.size());
+    }
+    break;
+  }
+  case K_WHILE:
+  case K_FOR: {
+    // init; goto test; body: ...; continue: loop; test: if cond goto body
+    bool is_for = ast.kind[id] == K_FOR;
+    NodeId cond = is_for ? op(id, 1) : ast.a[id];
+    if (is_for)
+      expr(op(id, 0), -1);
+    release(reg_mark);
+    size_t to_test = emit_wide(OP_JMP, 0, 0);
+    size_t body = bc.code.size();
+    loops.push_back(Loop());
+    block(is_for ? op(id, 3) : ast.b[id]);
+    size_t continue_at = bc.code.size();
+    if (is_for)
+      expr(op(id, 2), -1);
+    release(reg_mark);
+    patch(to_test, bc.code.size());
+    line = ast.line[id];
+    if (ast.kind[cond] == K_NO_EXPR) {
+      emit_wide(OP_JMP, 0, body);
+    } else {
+      int c = expr(cond, -1);
+      emit_wide(OP_JT, c, body);
+    }
+    loop_end(continue_at, bc.code.size());
+    break;
+  }
+  case K_RETURN:
+    if (ast.kind[ast.a[id]] == K_NO_EXPR)
+      emit(OP_RET_VOID);
+    else
+      emit(OP_RET, expr(ast.a[id], -1));
+    break;
+  case K_BREAK:
+    loops.back().breaks.push_back(emit_wide(OP_JMP, 0, 0));
+    break;
+  case K_CONTINUE:
+    loops.back().continues.push_back(emit_wide(OP_JMP, 0, 0));
+    break;
+  default:
+    expr(id, -1);
+    break;
+  }
+  release(reg_mark);
+}
+
+void BytecodeCompiler::function(NodeId decl)
+{
+  BytecodeFunction &f = bc.functions[functions[op(decl, 0)]];
+  current = &f;
+  f.entry = bc.code.size();
+  scope.clear();
+  next_reg = max_reg = 0;
+  NodeId params = op(decl, 1);
+  for (int i = 0; i < length(params); i++)
+    bind(ast.a[element(params, i)], ast.b[element(params, i)]);
+  line = ast.line[decl];
+  block(op(decl, 3));
+  emit(OP_RET_VOID);
+  f.registers = max_reg > 0 ? max_reg : 1;
+}
+
+// Children come before their parents, so one pass in id order finds
+// every expression that calls or assigns.
+void BytecodeCompiler::find_effects()
+{
+  effects.assign(ast.size(), false);
+  for (NodeId id = 0; id < (NodeId) ast.size(); id++) {
+    switch (ast.kind[id]) {
+    case K_CALL:
+    case K_ASSIGN:
+      effects[id] = true;
+      break;
+    case K_ACTUAL: case K_NEG: case K_NOT: case K_BITNOT:
+      effects[id] = effects[ast.a[id]];
+      break;
+    case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+    case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+    case K_AND: case K_OR: case K_XOR: case K_BITAND: case K_BITOR:
+      effects[id] = effects[ast.a[id]] || effects[ast.b[id]];
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void BytecodeCompiler::program()
+{
+  find_effects();
+  NodeId decls = ast.a[ast.root];
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] != K_CALL_DECL)
+      continue;       // globals cannot be used by any function
+    BytecodeFunction f;
+    f.name = idtable.lookup(op(d, 0))->get_string();
+    f.params = length(op(d, 1));
+    f.registers = 0;
+    f.entry = 0;
+    functions[op(d, 0)] = bc.functions.size();
+    returns.push_back(op(d, 2));
+    if (strcmp(f.name, "main") == 0)
+      bc.main = bc.functions.size();
+    bc.functions.push_back(f);
+  }
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] == K_CALL_DECL)
+      function(d);
+  }
+}
+
+void compile_bytecode(CompactAst &ast, Bytecode &bc)
+{
+  BytecodeCompiler compiler(ast, bc);
+  compiler.program();
+}
+
+#define OPCODE_NAME(op) #op,
+static const char *opcode_names[] = { OPCODES(OPCODE_NAME) };
+#undef OPCODE_NAME
+
+void Bytecode::dump(ostream &s)
+{
+  for (size_t f = 0; f < functions.size(); f++) {
+    BytecodeFunction &fn = functions[f];
+    size_t end = f + 1 < functions.size() ? functions[f + 1].entry
+                                          : code.size();
+    s << fn.name << ": " << fn.params << " params, " << fn.registers
+      << " registers\n";
+    for (size_t pc = fn.entry; pc < end; pc++) {
+      Instr &i = code[pc];
+      s << "  " << pc << "\t" << opcode_names[i.op] << "\t" << i.a << " "
+        << i.b << " " << i.c << "\t; line " << lines[pc] << "\n";
+    }
+  }
+}
@@ -0,0 +1,116 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+//////////////////////////////////////////////////////////////////////
+//
+//  bytecode.h
+//
+//  A register-based bytecode for Seal, and the virtual machine that
+//  runs it.  A program is compiled from its typed CompactAst (see
+//  compact-ast.h) after semant has accepted it, so every operation
+//  knows the types of its operands: there is one opcode per operator
+//  and operand type, and no run time type checks.
+//
+//  Each function runs in a window of registers: its parameters first,
+//  then every variable declared in it, then temporaries.  An
+//  instruction is 8 bytes, an opcode and three 16-bit operands; b and
+//  c together form a 32-bit operand for constants, jump targets and
+//  callees.
+//
+//     OP_MOV a b          r[a] = r[b]
+//     OP_LOADK a bc       r[a] = constants[bc]
+//     OP_ADD_I a b c      r[a] = r[b] + r[c], and likewise SUB, MUL,
+//                         DIV and MOD for Int and Float (_F), and
+//                         AND, OR and XOR for Int and Bool
+//     OP_NEG_I a b        r[a] = -r[b]; NEG_F, NOT (Bool), BITNOT (Int)
+//     OP_I2F a b          r[a] = (Float) r[b]
+//     OP_LT_I a b c       r[a] = r[b] < r[c], and LE, GT, GE, EQ, NE for
+//                         Int and Bool (_I) and Float (_F)
+//     OP_JMP bc           continue at code[bc]
+//     OP_JT a bc          ... if r[a] is true; OP_JF if it is false
+//     OP_CALL a bc        call functions[bc], whose registers start at
+//                         r[a]: the arguments are r[a], r[a+1], ...
+//                         The result is left in r[a].
+//     OP_RET a            return r[a]; OP_RET_VOID returns nothing
+//     OP_PRINTF a b c     printf with the b arguments r[a], ..., whose
+//                         types are print_types[c]
+//
+//  Registers hold a Value; Bool is an Int that is 0 or 1, and a String
+//  points at the characters of its stringtable entry.
+//
+//     void compile_bytecode(CompactAst &ast, Bytecode &bc)
+//       compiles a checked program.
+//     int run_bytecode(Bytecode &bc, FILE *out)
+//       runs main, with printf writing to out, and returns 0.  A run
+//       time error (division by zero, stack overflow) is reported on
+//       cerr with its line and ends the process with exit status 1.
+//     void Bytecode::dump(ostream &s)
+//       lists the instructions of every function.
+//
+//  The interpreter dispatches through a table of label addresses
+//  (computed goto), so it needs g++ or another compiler with GNU C
+//  extensions.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "compact-ast.h"
+#include "seal-runtime.h"
+
+#define OPCODES(X)                                                   \
+  X(MOV) X(LOADK)                                                    \
+  X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(MOD_I)                       \
+  X(ADD_F) X(SUB_F) X(MUL_F) X(DIV_F) X(MOD_F)                       \
+  X(AND) X(OR) X(XOR)                                                \
+  X(NEG_I) X(NEG_F) X(NOT) X(BITNOT) X(I2F)                          \
+  X(LT_I) X(LE_I) X(GT_I) X(GE_I) X(EQ_I) X(NE_I)                    \
+  X(LT_F) X(LE_F) X(GT_F) X(GE_F) X(EQ_F) X(NE_F)                    \
+  X(JMP) X(JT) X(JF)                                                 \
+  X(CALL) X(RET) X(RET_VOID) X(PRINTF)
+
+#define OPCODE_ENUM(op) OP_##op,
+enum Opcode { OPCODES(OPCODE_ENUM) NUM_OPCODES };
+#undef OPCODE_ENUM
+
+struct Instr {
+  unsigned short op, a, b, c;
+
+  unsigned int bc() const { return b | (unsigned int) c << 16; }
+};
+
+struct BytecodeFunction {
+  const char *name;
+  int params;
+  int registers;        // the size of its register window
+  unsigned int entry;   // index of its first instruction
+  std::vector<int> variables;   // registers of its parameters and variables
+};
+
+class Bytecode {
+public:
+  std::vector<Instr> code;
+  std::vector<int> lines;              // source line of each instruction
+  std::vector<Value> constants;
+  std::vector<char> constant_types;    // 'i', 'f' or 's' per constant
+  std::vector<BytecodeFunction> functions;
+  std::vector<std::string> print_types; // 'i', 'f', 'b' or 's' per argument
+  std::vector<unsigned int> boundaries; // instructions before which no
+                                       // temporary is live, in order
+  int main;                            // index of main in functions
+
+  Bytecode() : main(-1) { }
+
+  void dump(ostream &s);
+};
+
+void compile_bytecode(CompactAst &ast, Bytecode &bc);
+int run_bytecode(Bytecode &bc, FILE *out);
+
+#endif
@@ -0,0 +1,683 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  c-cgen.cc
+//
+//  The C backend (see c-cgen.h).  Like the bytecode compiler it is a
+//  switch on kind[id] over a checked CompactAst, writing each function
+//  into a buffer first, since the temporaries its expressions need are
+//  only known at the end and are declared at the top.
+//
+//  C does not say in which order the operands of an operator or the
+//  arguments of a call are evaluated, where Seal goes left to right.
+//  The order shows only when an operand has effects, a call or an
+//  assignment; then the operands before it are stored in temporaries
+//  with the comma operator, which is sequenced:
+//
+//     f() + g()   =>   (t0 = f(), (t0 + g()))
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <unordered_map>
+#include "c-cgen.h"
+#include "utilities.h"
+
+// Helpers every generated program starts with.
+static const char *prelude =
+  "#include <math.h>\n"
+  "#include <stdio.h>\n"
+  "#include \"seal-runtime.h\"\n"
+  "\n"
+  "/* Calls in progress.  It is counted down after every call, so that\n"
+  "   no call is a tail call that the C compiler could turn into a jump:\n"
+  "   runaway recursion must run out of stack. */\n"
+  "static long seal_depth;\n"
+  "\n"
+  "static inline void seal_enter(long line)\n"
+  "{\n"
+  "  char here;\n"
+  "  if (&here < seal_stack_limit)\n"
+  "    seal_stack_overflow(line);\n"
+  "  seal_depth++;\n"
+  "}\n"
+  "\n"
+  "static inline long seal_div(long x, long y, long line)\n"
+  "{\n"
+  "  if (y == 0)\n"
+  "    seal_division_by_zero(line);\n"
+  "  return y == -1 ? (long) -(unsigned long) x : x / y;\n"
+  "}\n"
+  "\n"
+  "static inline long seal_mod(long x, long y, long line)\n"
+  "{\n"
+  "  if (y == 0)\n"
+  "    seal_division_by_zero(line);\n"
+  "  return y == -1 ? 0 : x % y;\n"
+  "}\n";
+
+class CCodegen {
+private:
+  CompactAst &ast;
+  ostream &s;
+  unsigned int Int, Float, Bool, String, printf_name;   // idtable indices
+
+  std::unordered_map<unsigned int, NodeId> functions;   // name -> decl
+  std::unordered_map<unsigned int, unsigned int> globals; // name -> type
+  std::vector<bool> effects;     // by node: it calls or assigns
+
+  // the function being written
+  struct Binding {
+    unsigned int name;
+    unsigned int type;
+  };
+  std::vector<Binding> scope;         // variables in scope, innermost last
+  std::vector<unsigned int> temps;    // type of each temporary t<k>
+  std::vector<int> prints;            // size of each printf array p<k>
+  int indent;
+  int line;
+
+  NodeId op(NodeId id, int i) { return ast.lists[ast.a[id] + i]; }
+  int length(NodeId list) { return ast.b[list]; }
+  NodeId element(NodeId list, int i) { return ast.lists[ast.a[list] + i]; }
+  const char *name(unsigned int id) { return idtable.lookup(id)->get_string(); }
+  bool is_constant(NodeId id);
+
+  void error(const char *message);
+  unsigned int lookup(unsigned int name);
+  unsigned int type_of(NodeId id);
+  void declare(ostream &o, unsigned int type, const char *prefix,
+               const char *var);
+  ostream &tab(ostream &o);
+
+  void find_effects();
+  void constants();
+  void operand(ostream &o, NodeId id, bool as_float);
+  void binary(ostream &o, NodeId id, bool as_float, const char *prefix,
+              const char *middle, const char *suffix);
+  void call(ostream &o, NodeId id);
+  void expr(ostream &o, NodeId id);
+  void stmt(ostream &o, NodeId id);
+  void block(ostream &o, NodeId id);
+  void prototype(ostream &o, NodeId decl);
+  void function(NodeId decl);
+
+public:
+  CCodegen(CompactAst &a, ostream &out);
+  void program();
+};
+
+CCodegen::CCodegen(CompactAst &a, ostream &out)
+  : ast(a), s(out), indent(0), line(0)
+{
+  Int = symbol_id(idtable.lookup_string("Int"));
+  Float = symbol_id(idtable.lookup_string("Float"));
+  Bool = symbol_id(idtable.lookup_string("Bool"));
+  String = symbol_id(idtable.lookup_string("String"));
+  printf_name = symbol_id(idtable.lookup_string("printf"));
+}
+
+bool CCodegen::is_constant(NodeId id)
+{
+  int k = ast.kind[id];
+  return k == K_CONST_INT || k == K_CONST_FLOAT || k == K_CONST_STRING ||
+         k == K_CONST_BOOL;
+}
+
+void CCodegen::error(const char *message)
+{
+  diagnostics() << line << ": " << message << "\n";
+  abort_compilation(1);
+}
+
+unsigned int CCodegen::lookup(unsigned int name)
+{
+  for (size_t i = scope.size(); i > 0; i--)
+    if (scope[i - 1].name == name)
+      return scope[i - 1].type;
+  std::unordered_map<unsigned int, unsigned int>::iterator it =
+    globals.find(name);
+  if (it == globals.end())
+    error("an argument of printf uses an undefined variable");
+  return it->second;
+}
+
+// The type of the expression id: the one semant gave it, or for the
+// unchecked arguments of printf, the one it would have given it.
+unsigned int CCodegen::type_of(NodeId id)
+{
+  unsigned int t = ast.type[id];
+  if (t == Int || t == Float || t == Bool || t == String)
+    return t;
+  switch (ast.kind[id]) {
+  case K_CONST_INT: return Int;
+  case K_CONST_FLOAT: return Float;
+  case K_CONST_STRING: return String;
+  case K_CONST_BOOL: return Bool;
+  case K_OBJECT: case K_ASSIGN: return lookup(ast.a[id]);
+  case K_ACTUAL: return type_of(ast.a[id]);
+  case K_CALL:
+    if (functions.count(ast.a[id]) == 0)
+      return NO_ID;
+    return op(functions[ast.a[id]], 2);
+  case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+    return type_of(ast.a[id]) == Float || type_of(ast.b[id]) == Float
+           ? Float : Int;
+  case K_XOR: case K_BITAND: case K_BITOR: case K_NEG: case K_BITNOT:
+    return type_of(ast.a[id]);
+  case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+  case K_AND: case K_OR: case K_NOT:
+    return Bool;
+  default:
+    return NO_ID;
+  }
+}
+
+// Write the declaration of prefix+var with the C type for type.
+void CCodegen::declare(ostream &o, unsigned int type, const char *prefix,
+                       const char *var)
+{
+  if (type == Float)
+    o << "double ";
+  else if (type == String)
+    o << "const char *";
+  else if (type == Int || type == Bool)
+    o << "long ";
+  else
+    o << "void ";
+  o << prefix << var;
+}
+
+ostream &CCodegen::tab(ostream &o)
+{
+  for (int i = 0; i < indent; i++)
+    o << "  ";
+  return o;
+}
+
+// Children come before their parents, so one pass in id order finds
+// every expression that calls or assigns.
+void CCodegen::find_effects()
+{
+  effects.assign(ast.size(), false);
+  for (NodeId id = 0; id < (NodeId) ast.size(); id++) {
+    switch (ast.kind[id]) {
+    case K_CALL:
+    case K_ASSIGN:
+      effects[id] = true;
+      break;
+    case K_ACTUAL: case K_NEG: case K_NOT: case K_BITNOT:
+      effects[id] = effects[ast.a[id]];
+      break;
+    case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+    case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+    case K_AND: case K_OR: case K_XOR: case K_BITAND: case K_BITOR:
+      effects[id] = effects[ast.a[id]] || effects[ast.b[id]];
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+static void emit_string(ostream &s, const char *str)
+{
+  s << "\"";
+  for (const unsigned char *p = (const unsigned char *) str; *p; p++) {
+    // '?' too, so that no trigraph can form
+    if (*p == '"' || *p == '\\' || *p == '?')
+      s << '\\' << *p;
+    else if (*p >= ' ' && *p < 127)
+      s << *p;
+    else {
+      char octal[8];
+      snprintf(octal, sizeof octal, "\\%03o", *p);
+      s << octal;
+    }
+  }
+  s << "\"";
+}
+
+// The constants the program uses, each once.
+void CCodegen::constants()
+{
+  std::vector<bool> ints, floats, strings;
+  for (NodeId id = 0; id < (NodeId) ast.size(); id++) {
+    int k = ast.kind[id];
+    unsigned int c = ast.a[id];
+    std::vector<bool> &done = k == K_CONST_INT ? ints
+                              : k == K_CONST_FLOAT ? floats : strings;
+    if (k != K_CONST_INT && k != K_CONST_FLOAT && k != K_CONST_STRING)
+      continue;
+    if (done.size() <= c)
+      done.resize(c + 1);
+    if (done[c])
+      continue;
+    done[c] = true;
+    if (k == K_CONST_INT) {
+      s << "static const long int" << c << " = "
+        << strtol(inttable.lookup(c)->get_string(), NULL, 10) << "L;\n";
+    } else if (k == K_CONST_FLOAT) {
+      double v = strtod(floattable.lookup(c)->get_string(), NULL);
+      s << "static const double flt" << c << " = ";
+      if (isinf(v)) {
+        s << "HUGE_VAL;\n";
+      } else {
+        char exact[40];
+        snprintf(exact, sizeof exact, "%.17g", v);
+        s << exact << (strpbrk(exact, ".e") ? "" : ".0") << ";\n";
+      }
+    } else {
+      s << "static const char str" << c << "[] = ";
+      emit_string(s, stringtable.lookup(c)->get_string());
+      s << ";\n";
+    }
+  }
+}
+
+// An operand of an arithmetic or comparison operator, converted to
+// double if the operator works on Floats.
+void CCodegen::operand(ostream &o, NodeId id, bool as_float)
+{
+  if (as_float && type_of(id) == Int)
+    o << "(double) ";
+  expr(o, id);
+}
+
+// prefix left middle right suffix, with the left operand stored in a
+// temporary first if the order of the two can be seen.
+void CCodegen::binary(ostream &o, NodeId id, bool as_float,
+                      const char *prefix, const char *middle,
+                      const char *suffix)
+{
+  NodeId left = ast.a[id], right = ast.b[id];
+  if (effects[right] || (effects[left] && !is_constant(right))) {
+    int t = temps.size();
+    temps.push_back(as_float ? Float : type_of(left));
+    o << "(t" << t << " = ";
+    operand(o, left, as_float);
+    o << ", " << prefix << "t" << t << middle;
+    operand(o, right, as_float);
+    o << suffix << ")";
+  } else {
+    o << prefix;
+    operand(o, left, as_float);
+    o << middle;
+    operand(o, right, as_float);
+    o << suffix;
+  }
+}
+
+// A call, after a check for stack overflow, with its result in a
+// temporary so that seal_depth can be counted down after it.  printf
+// stores its arguments into an array of Values for seal_print.
+void CCodegen::call(ostream &o, NodeId id)
+{
+  NodeId args = ast.b[id];
+  int n = length(args);
+
+  if (ast.a[id] == printf_name) {
+    int p = prints.size();
+    prints.push_back(n);
+    std::string types;
+    o << "(";
+    for (int i = 0; i < n; i++) {
+      unsigned int t = type_of(element(args, i));
+      types += t == Float ? 'f' : t == String ? 's' : t == Bool ? 'b' : 'i';
+      o << "p" << p << "[" << i << "]."
+        << (t == Float ? 'f' : t == String ? 's' : 'i') << " = ";
+      expr(o, element(args, i));
+      o << ", ";
+    }
+    o << "seal_print(stdout, p" << p << ", \"" << types << "\"))";
+    return;
+  }
+
+  if (functions.count(ast.a[id]) == 0)
+    error("an argument of printf calls an undefined function");
+  if (n != length(op(functions[ast.a[id]], 1)))
+    error("an argument of printf calls a function with the wrong "
+          "number of arguments");
+  bool ordered = false;
+  for (int i = 0; i < n; i++)
+    ordered = ordered || effects[element(args, i)];
+  int first = temps.size();
+  if (ordered)
+    for (int i = 0; i < n; i++)
+      temps.push_back(type_of(element(args, i)));
+  o << "(";
+  if (ordered)
+    for (int i = 0; i < n; i++) {
+      o << "t" << first + i << " = ";
+      expr(o, element(args, i));
+      o << ", ";
+    }
+  o << "seal_enter(" << line << "), ";
+  unsigned int type = op(functions[ast.a[id]], 2);
+  bool has_value = type == Int || type == Bool || type == Float ||
+                   type == String;
+  int result = temps.size();
+  if (has_value) {
+    temps.push_back(type);
+    o << "t" << result << " = ";
+  }
+  o << "f_" << name(ast.a[id]) << "(";
+  for (int i = 0; i < n; i++) {
+    if (i > 0)
+      o << ", ";
+    if (ordered)
+      o << "t" << first + i;
+    else
+      expr(o, element(args, i));
+  }
+  o << "), seal_depth--";
+  if (has_value)
+    o << ", t" << result;
+  o << ")";
+}
+
+void CCodegen::expr(ostream &o, NodeId id)
+{
+  // K_ADD, K_MINUS, K_MULTI
+  static const char *float_ops[] = { " + ", " - ", " * " };
+  static const char *int_ops[] = { " + (unsigned long) ",
+                                   " - (unsigned long) ",
+                                   " * (unsigned long) " };
+  // K_LT, K_LE, K_EQU, K_NEQ, K_GE, K_GT
+  static const char *compares[] = { " < ", " <= ", " == ", " != ", " >= ",
+                                    " > " };
+  int kind = ast.kind[id];
+  int saved_line = line;
+  line = ast.line[id];
+
+  switch (kind) {
+  case K_CONST_INT:
+    o << "int" << ast.a[id];
+    break;
+  case K_CONST_FLOAT:
+    o << "flt" << ast.a[id];
+    break;
+  case K_CONST_STRING:
+    o << "str" << ast.a[id];
+    break;
+  case K_CONST_BOOL:
+    o << (ast.a[id] != 0);
+    break;
+  case K_OBJECT:
+    type_of(id);        // reports undefined names in printf
+    o << "v_" << name(ast.a[id]);
+    break;
+  case K_ASSIGN:
+    type_of(id);
+    o << "(v_" << name(ast.a[id]) << " = ";
+    expr(o, ast.b[id]);
+    o << ")";
+    break;
+  case K_ACTUAL:
+    expr(o, ast.a[id]);
+    break;
+  case K_CALL:
+    call(o, id);
+    break;
+  case K_ADD: case K_MINUS: case K_MULTI:
+    // Int arithmetic wraps, which it only does on unsigned long in C.
+    if (type_of(id) == Float)
+      binary(o, id, true, "(", float_ops[kind - K_ADD], ")");
+    else
+      binary(o, id, false, "(long) ((unsigned long) ", int_ops[kind - K_ADD],
+             ")");
+    break;
+  case K_DIVIDE: case K_MOD:
+    if (type_of(id) == Float) {
+      binary(o, id, true, kind == K_DIVIDE ? "(" : "fmod(",
+             kind == K_DIVIDE ? " / " : ", ", ")");
+    } else {
+      std::ostringstream suffix;
+      suffix << ", " << line << ")";
+      binary(o, id, false, kind == K_DIVIDE ? "seal_div(" : "seal_mod(",
+             ", ", suffix.str().c_str());
+    }
+    break;
+  case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+    binary(o, id,
+           type_of(ast.a[id]) == Float || type_of(ast.b[id]) == Float,
+           "(", compares[kind - K_LT], ")");
+    break;
+  case K_AND:
+  case K_OR:
+    // && and || are sequenced already.
+    o << "(";
+    expr(o, ast.a[id]);
+    o << (kind == K_AND ? " && " : " || ");
+    expr(o, ast.b[id]);
+    o << ")";
+    break;
+  case K_XOR:
+    binary(o, id, false, "(", " ^ ", ")");
+    break;
+  case K_BITAND:
+    binary(o, id, false, "(", " & ", ")");
+    break;
+  case K_BITOR:
+    binary(o, id, false, "(", " | ", ")");
+    break;
+  case K_NEG:
+    o << (type_of(id) == Float ? "(-" : "((long) -(unsigned long) ");
+    expr(o, ast.a[id]);
+    o << ")";
+    break;
+  case K_NOT:
+  case K_BITNOT:
+    o << (kind == K_NOT ? "(!" : "(~");
+    expr(o, ast.a[id]);
+    o << ")";
+    break;
+  case K_NO_EXPR:
+    break;
+  default:
+    fatal_error("c-cgen: unexpected node in an expression\n");
+  }
+  line = saved_line;
+}
+
+// "{", the block's variables, cleared, and its statements, up to and
+// including the "}".
+void CCodegen::block(ostream &o, NodeId id)
+{
+  size_t scope_mark = scope.size();
+  o << "{\n";
+  indent++;
+  NodeId decls = ast.a[id];
+  for (int i = 0; i < length(decls); i++) {
+    NodeId var = ast.a[element(decls, i)];
+    Binding b = { ast.a[var], ast.b[var] };
+    scope.push_back(b);
+    tab(o);
+    declare(o, ast.b[var], "v_", name(ast.a[var]));
+    o << " = 0;\n";
+  }
+  NodeId stmts = ast.b[id];
+  for (int i = 0; i < length(stmts); i++)
+    stmt(o, element(stmts, i));
+  indent--;
+  tab(o) << "}";
+  scope.resize(scope_mark);
+}
+
+void CCodegen::stmt(ostream &o, NodeId id)
+{
+  line = ast.line[id];
+  switch (ast.kind[id]) {
+  case K_STMT_BLOCK:
+    tab(o);
+    block(o, id);
+    o << "\n";
+    break;
+  case K_IF: {
+    tab(o) << "if (";
+    expr(o, op(id, 0));
+    o << ") ";
+    block(o, op(id, 1));
+    NodeId else_block = op(id, 2);
+    if (length(ast.a[else_block]) > 0 || length(ast.b[else_block]) > 0) {
+      o << " else ";
+      block(o, else_block);
+    }
+    o << "\n";
+    break;
+  }
+  case K_WHILE:
+    tab(o) << "while (";
+    expr(o, ast.a[id]);
+    o << ") ";
+    block(o, ast.b[id]);
+    o << "\n";
+    break;
+  case K_FOR:
+    tab(o) << "for (";
+    expr(o, op(id, 0));
+    o << "; ";
+    expr(o, op(id, 1));
+    o << "; ";
+    expr(o, op(id, 2));
+    o << ") ";
+    block(o, op(id, 3));
+    o << "\n";
+    break;
+  case K_RETURN:
+    tab(o) << "return";
+    if (ast.kind[ast.a[id]] != K_NO_EXPR) {
+      o << " ";
+      expr(o, ast.a[id]);
+    }
+    o << ";\n";
+    break;
+  case K_BREAK:
+    tab(o) << "break;\n";
+    break;
+  case K_CONTINUE:
+    tab(o) << "continue;\n";
+    break;
+  case K_NO_EXPR:
+    break;
+  default:
+    tab(o);
+    expr(o, id);
+    o << ";\n";
+    break;
+  }
+}
+
+void CCodegen::prototype(ostream &o, NodeId decl)
+{
+  o << "static ";
+  declare(o, op(decl, 2), "f_", name(op(decl, 0)));
+  o << "(";
+  NodeId params = op(decl, 1);
+  for (int i = 0; i < length(params); i++) {
+    NodeId var = element(params, i);
+    if (i > 0)
+      o << ", ";
+    declare(o, ast.b[var], "v_", name(ast.a[var]));
+  }
+  if (length(params) == 0)
+    o << "void";
+  o << ")";
+}
+
+// The body is a block of its own, so that its variables may shadow
+// the parameters as they do in Seal.
+void CCodegen::function(NodeId decl)
+{
+  scope.clear();
+  temps.clear();
+  prints.clear();
+  NodeId params = op(decl, 1);
+  for (int i = 0; i < length(params); i++) {
+    NodeId var = element(params, i);
+    Binding b = { ast.a[var], ast.b[var] };
+    scope.push_back(b);
+  }
+  std::ostringstream body;
+  indent = 1;
+  tab(body);
+  block(body, op(decl, 3));
+  body << "\n";
+
+  s << "\n";
+  prototype(s, decl);
+  s << "\n{\n";
+  for (size_t k = 0; k < temps.size(); k++) {
+    std::ostringstream t;
+    t << k;
+    s << "  ";
+    declare(s, temps[k], "t", t.str().c_str());
+    s << ";\n";
+  }
+  for (size_t k = 0; k < prints.size(); k++)
+    s << "  union Value p" << k << "[" << prints[k] << "];\n";
+  s << body.str();
+  // Falling off the end returns 0, where the caller needs a value.
+  unsigned int type = op(decl, 2);
+  if (type == Int || type == Bool || type == Float || type == String)
+    s << "  return 0;\n";
+  s << "}\n";
+}
+
+void CCodegen::program()
+{
+  find_effects();
+  NodeId decls = ast.a[ast.root];
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] == K_CALL_DECL) {
+      functions[op(d, 0)] = d;
+    } else {
+      NodeId var = ast.a[d];
+      globals[ast.a[var]] = ast.b[var];
+    }
+  }
+
+  s << prelude << "\n";
+  constants();
+  s << "\n";
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] == K_CALL_DECL) {
+      prototype(s, d);
+      s << ";\n";
+    } else {
+      NodeId var = ast.a[d];
+      s << "static ";
+      declare(s, ast.b[var], "v_", name(ast.a[var]));
+      s << ";\n";
+    }
+  }
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] == K_CALL_DECL)
+      function(d);
+  }
+
+  s << "\nvoid seal_start(void)\n{\n";
+  for (int i = 0; i < length(decls); i++) {
+    NodeId d = element(decls, i);
+    if (ast.kind[d] == K_CALL_DECL && strcmp(name(op(d, 0)), "main") == 0)
+      s << "  f_main();\n";
+  }
+  s << "}\n";
+}
+
+void emit_c(CompactAst &ast, ostream &s)
+{
+  CCodegen(ast, s).program();
+}
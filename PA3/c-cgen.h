@@ -0,0 +1,46 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef C_CGEN_H
+#define C_CGEN_H
+//////////////////////////////////////////////////////////////////////
+//
+//  c-cgen.h
+//
+//  A backend that translates a checked program into portable C, to be
+//  built by any C compiler with the runtime in seal-runtime.c:
+//
+//     semant -C prog.seal -o prog.c
+//     gcc -O2 -I<this directory> prog.c seal-runtime.c -lm -o prog
+//
+//  It works on the lowered CompactAst, so it sees the types semant
+//  gave every node.  Each function becomes a static C function f_name
+//  and each variable a C variable v_name, local or global, of type
+//  long (Int and Bool), double (Float) or const char * (String); the
+//  prefixes keep Seal names off C keywords and library functions.
+//  Function bodies keep their Seal blocks, so if, while and for map
+//  directly onto C statements and every expression onto one C
+//  expression.  The Int, Float and String constants are static data
+//  named after their index in inttable, floattable and stringtable.
+//
+//  The program behaves as it does on the VM (bytecode.h): Int
+//  arithmetic wraps, division by zero and runaway recursion are the
+//  same runtime errors, printf goes through the same seal_print, and
+//  operands are evaluated left to right even where C would not
+//  promise it.  Unlike the bytecode, global variables are supported.
+//
+//     void emit_c(CompactAst &ast, ostream &s)
+//       writes the program to s.  Errors in the arguments of printf,
+//       which semant does not check, are reported as the bytecode
+//       compiler reports them.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "compact-ast.h"
+
+void emit_c(CompactAst &ast, ostream &s);
+
+#endif
@@ -0,0 +1,458 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  compact-ast.cc
+//
+//  Lowering of the class AST into a CompactAst, and the passes that
+//  run over the compact form.  Every lower method lowers the node's
+//  children first and then appends the node itself, so ids come out
+//  in post-order.  The passes are plain switches on kind[id]; there
+//  are no virtual calls once the tree has been lowered.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "seal-decl.h"
+#include "seal-stmt.h"
+#include "seal-expr.h"
+#include "compact-ast.h"
+#include "operator-rules.h"
+#include "utilities.h"
+
+//
+// Lowering
+//
+
+NodeId Program_class::lower(CompactAst &ast)
+{
+  NodeId list = ast.add_list(decls);
+  ast.root = ast.add(K_PROGRAM, line_number, NO_ID, list);
+  return ast.root;
+}
+
+NodeId Variable_class::lower(CompactAst &ast)
+{
+  return ast.add(K_VARIABLE, line_number, NO_ID,
+                 symbol_id(name), symbol_id(type));
+}
+
+NodeId VariableDecl_class::lower(CompactAst &ast)
+{
+  NodeId var = variable->lower(ast);
+  return ast.add(K_VARIABLE_DECL, line_number, NO_ID, var);
+}
+
+NodeId CallDecl_class::lower(CompactAst &ast)
+{
+  NodeId params = ast.add_list(paras);
+  NodeId block = body->lower(ast);
+  unsigned int ops = ast.add_operands({ symbol_id(name), params,
+                                        symbol_id(returnType), block });
+  return ast.add(K_CALL_DECL, line_number, NO_ID, ops);
+}
+
+NodeId StmtBlock_class::lower(CompactAst &ast)
+{
+  NodeId decls = ast.add_list(vars);
+  NodeId body = ast.add_list(stmts);
+  return ast.add(K_STMT_BLOCK, line_number, NO_ID, decls, body);
+}
+
+NodeId IfStmt_class::lower(CompactAst &ast)
+{
+  NodeId cond = condition->lower(ast);
+  NodeId then_block = thenexpr->lower(ast);
+  NodeId else_block = elseexpr->lower(ast);
+  unsigned int ops = ast.add_operands({ cond, then_block, else_block });
+  return ast.add(K_IF, line_number, NO_ID, ops);
+}
+
+NodeId WhileStmt_class::lower(CompactAst &ast)
+{
+  NodeId cond = condition->lower(ast);
+  NodeId block = body->lower(ast);
+  return ast.add(K_WHILE, line_number, NO_ID, cond, block);
+}
+
+NodeId ForStmt_class::lower(CompactAst &ast)
+{
+  NodeId init = initexpr->lower(ast);
+  NodeId cond = condition->lower(ast);
+  NodeId loop = loopact->lower(ast);
+  NodeId block = body->lower(ast);
+  unsigned int ops = ast.add_operands({ init, cond, loop, block });
+  return ast.add(K_FOR, line_number, NO_ID, ops);
+}
+
+NodeId ReturnStmt_class::lower(CompactAst &ast)
+{
+  NodeId v = value->lower(ast);
+  return ast.add(K_RETURN, line_number, NO_ID, v);
+}
+
+NodeId ContinueStmt_class::lower(CompactAst &ast)
+{
+  return ast.add(K_CONTINUE, line_number, NO_ID);
+}
+
+NodeId BreakStmt_class::lower(CompactAst &ast)
+{
+  return ast.add(K_BREAK, line_number, NO_ID);
+}
+
+NodeId Assign_class::lower(CompactAst &ast)
+{
+  NodeId v = value->lower(ast);
+  return ast.add(K_ASSIGN, line_number, symbol_id(type),
+                 symbol_id(lvalue), v);
+}
+
+// The operator classes differ only in their kind.
+#define LOWER_BINARY(cls, k)                                         \
+NodeId cls::lower(CompactAst &ast)                                   \
+{                                                                    \
+  NodeId left = e1->lower(ast);                                      \
+  NodeId right = e2->lower(ast);                                     \
+  return ast.add(k, line_number, symbol_id(type), left, right);      \
+}
+
+#define LOWER_UNARY(cls, k)                                          \
+NodeId cls::lower(CompactAst &ast)                                   \
+{                                                                    \
+  NodeId operand = e1->lower(ast);                                   \
+  return ast.add(k, line_number, symbol_id(type), operand);          \
+}
+
+LOWER_BINARY(Add_class, K_ADD)
+LOWER_BINARY(Minus_class, K_MINUS)
+LOWER_BINARY(Multi_class, K_MULTI)
+LOWER_BINARY(Divide_class, K_DIVIDE)
+LOWER_BINARY(Mod_class, K_MOD)
+LOWER_BINARY(Lt_class, K_LT)
+LOWER_BINARY(Le_class, K_LE)
+LOWER_BINARY(Equ_class, K_EQU)
+LOWER_BINARY(Neq_class, K_NEQ)
+LOWER_BINARY(Ge_class, K_GE)
+LOWER_BINARY(Gt_class, K_GT)
+LOWER_BINARY(And_class, K_AND)
+LOWER_BINARY(Or_class, K_OR)
+LOWER_BINARY(Xor_class, K_XOR)
+LOWER_BINARY(Bitand_class, K_BITAND)
+LOWER_BINARY(Bitor_class, K_BITOR)
+LOWER_UNARY(Neg_class, K_NEG)
+LOWER_UNARY(Not_class, K_NOT)
+LOWER_UNARY(Bitnot_class, K_BITNOT)
+
+NodeId Const_int_class::lower(CompactAst &ast)
+{
+  return ast.add(K_CONST_INT, line_number, symbol_id(type), symbol_id(value));
+}
+
+NodeId Const_string_class::lower(CompactAst &ast)
+{
+  return ast.add(K_CONST_STRING, line_number, symbol_id(type),
+                 symbol_id(value));
+}
+
+NodeId Const_float_class::lower(CompactAst &ast)
+{
+  return ast.add(K_CONST_FLOAT, line_number, symbol_id(type),
+                 symbol_id(value));
+}
+
+NodeId Const_bool_class::lower(CompactAst &ast)
+{
+  return ast.add(K_CONST_BOOL, line_number, symbol_id(type), value);
+}
+
+NodeId Object_class::lower(CompactAst &ast)
+{
+  return ast.add(K_OBJECT, line_number, symbol_id(type), symbol_id(var));
+}
+
+NodeId Call_class::lower(CompactAst &ast)
+{
+  NodeId args = ast.add_list(actuals);
+  return ast.add(K_CALL, line_number, symbol_id(type), symbol_id(name), args);
+}
+
+NodeId Actual_class::lower(CompactAst &ast)
+{
+  NodeId e = expr->lower(ast);
+  return ast.add(K_ACTUAL, line_number, symbol_id(type), e);
+}
+
+NodeId No_expr_class::lower(CompactAst &ast)
+{
+  return ast.add(K_NO_EXPR, line_number, symbol_id(type));
+}
+
+size_t CompactAst::bytes() const
+{
+  return kind.size() * sizeof(kind[0]) + line.size() * sizeof(line[0]) +
+         type.size() * sizeof(type[0]) + a.size() * sizeof(a[0]) +
+         b.size() * sizeof(b[0]) + lists.size() * sizeof(lists[0]);
+}
+
+//
+// Dumping.  The output is byte for byte that of dump_with_types on
+// the class AST (see dumptype.cc), including which operators print
+// their type and which only print the "(type)" heading.
+//
+
+// Operators whose dump_with_types prints the type after "(type)".
+static bool dumps_op_type(int k)
+{
+  switch (k) {
+  case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+  case K_LT: case K_NEG:
+    return true;
+  }
+  return false;
+}
+
+static void dump_id(DumpWriter& stream, int n, unsigned int id)
+{
+  stream << indent(n) << idtable.lookup(id) << endl;
+}
+
+void CompactAst::dump_type(DumpWriter& stream, NodeId id, int n)
+{
+  stream << indent(n+2) << "(type)\n";
+  if (type[id] != NO_ID)
+    { stream << indent(n) << ": " << idtable.lookup(type[id]) << endl; }
+  else
+    { stream << indent(n) << ": _no_type" << endl; }
+}
+
+void CompactAst::dump_list(DumpWriter& stream, NodeId list, int n)
+{
+  stream << indent(n) << "(\n";
+  for (unsigned int i = a[list]; i < a[list] + b[list]; i++)
+    dump_node(stream, lists[i], n);
+  stream << indent(n) << ")\n";
+}
+
+void CompactAst::dump_with_types(DumpWriter& stream, int n)
+{
+  if (root != NO_ID)
+    dump_node(stream, root, n);
+}
+
+void CompactAst::dump_node(DumpWriter& stream, NodeId id, int n)
+{
+  const NodeId *ops = lists.data() + a[id];
+  stream << indent(n) << "#" << line[id] << "\n";
+
+  switch (kind[id]) {
+  case K_PROGRAM:
+    stream << indent(n) << "Program\n";
+    for (unsigned int i = a[a[id]]; i < a[a[id]] + b[a[id]]; i++)
+      dump_node(stream, lists[i], n+2);
+    break;
+  case K_VARIABLE_DECL:
+    stream << indent(n) << "Variable Declaration\n";
+    dump_node(stream, a[id], n+2);
+    break;
+  case K_VARIABLE:
+    stream << indent(n) << "Variable\n";
+    stream << indent(n+2) << "(name)\n";
+    dump_id(stream, n+2, a[id]);
+    stream << indent(n+2) << "(type)\n";
+    dump_id(stream, n+2, b[id]);
+    break;
+  case K_CALL_DECL:
+    stream << indent(n) << "Call Declaration\n";
+    stream << indent(n+2) << "(name)\n";
+    dump_id(stream, n+2, ops[0]);
+    stream << indent(n+2) << "(parameters)\n";
+    dump_list(stream, ops[1], n+2);
+    stream << indent(n+2) << "(return type)\n";
+    dump_id(stream, n+2, ops[2]);
+    stream << indent(n+2) << "(body)\n";
+    dump_node(stream, ops[3], n+2);
+    break;
+  case K_STMT_BLOCK:
+    stream << indent(n) << "Statement Block\n";
+    stream << indent(n+2) << "(variable declarations)\n";
+    dump_list(stream, a[id], n+2);
+    stream << indent(n+2) << "(statements)\n";
+    dump_list(stream, b[id], n+2);
+    break;
+  case K_IF:
+    stream << indent(n) << "IfStmt\n";
+    stream << indent(n+2) << "(condition)\n";
+    dump_node(stream, ops[0], n+2);
+    stream << indent(n+2) << "(then)\n";
+    dump_node(stream, ops[1], n+2);
+    stream << indent(n+2) << "(else)\n";
+    dump_node(stream, ops[2], n+2);
+    break;
+  case K_WHILE:
+    stream << indent(n) << "WhileStmt\n";
+    stream << indent(n+2) << "(condition)\n";
+    dump_node(stream, a[id], n+2);
+    stream << indent(n+2) << "(body)\n";
+    dump_node(stream, b[id], n+2);
+    break;
+  case K_FOR:
+    stream << indent(n) << "ForStmt\n";
+    stream << indent(n+2) << "(init)\n";
+    dump_node(stream, ops[0], n+2);
+    stream << indent(n+2) << "(condition)\n";
+    dump_node(stream, ops[1], n+2);
+    stream << indent(n+2) << "(loop)\n";
+    dump_node(stream, ops[2], n+2);
+    stream << indent(n+2) << "(body)\n";
+    dump_node(stream, ops[3], n+2);
+    break;
+  case K_BREAK:
+    stream << indent(n) << "BreakStmt\n";
+    break;
+  case K_CONTINUE:
+    stream << indent(n) << "ContinueStmt\n";
+    break;
+  case K_RETURN:
+    stream << indent(n) << "ReturnStmt\n";
+    stream << indent(n+2) << "(return value)\n";
+    dump_node(stream, a[id], n+2);
+    break;
+  case K_ASSIGN:
+    stream << indent(n) << "Assign\n";
+    stream << indent(n+2) << "(left value)\n";
+    dump_id(stream, n+2, a[id]);
+    stream << indent(n+2) << "(right value)\n";
+    dump_node(stream, b[id], n+2);
+    dump_type(stream, id, n);
+    break;
+  case K_ADD: case K_MINUS: case K_MULTI: case K_DIVIDE: case K_MOD:
+  case K_LT: case K_LE: case K_EQU: case K_NEQ: case K_GE: case K_GT:
+  case K_AND: case K_OR: case K_XOR: case K_BITAND: case K_BITOR:
+    stream << indent(n) << operator_rule(kind[id]).name << "\n";
+    stream << indent(n+2) << "(OP left)\n";
+    dump_node(stream, a[id], n+2);
+    stream << indent(n+2) << "(OP right)\n";
+    dump_node(stream, b[id], n+2);
+    if (dumps_op_type(kind[id]))
+      dump_type(stream, id, n);
+    else
+      stream << indent(n+2) << "(type)\n";
+    break;
+  case K_NEG: case K_NOT: case K_BITNOT:
+    stream << indent(n) << operator_rule(kind[id]).name << "\n";
+    stream << indent(n+2) << "(OP)\n";
+    dump_node(stream, a[id], n+2);
+    if (dumps_op_type(kind[id]))
+      dump_type(stream, id, n);
+    else
+      stream << indent(n+2) << "(type)\n";
+    break;
+  case K_OBJECT:
+    stream << indent(n) << "Object\n";
+    stream << indent(n+2) << "(name)\n";
+    dump_id(stream, n+2, a[id]);
+    dump_type(stream, id, n);
+    break;
+  case K_CALL:
+    stream << indent(n) << "Call\n";
+    stream << indent(n+2) << "(name)\n";
+    dump_id(stream, n+2, a[id]);
+    stream << indent(n+2) << "(actual parameters)\n";
+    dump_list(stream, b[id], n+2);
+    dump_type(stream, id, n);
+    break;
+  case K_ACTUAL:
+    stream << indent(n) << "Actual\n";
+    stream << indent(n+2) << "(expr)\n";
+    dump_node(stream, a[id], n+2);
+    dump_type(stream, id, n);
+    break;
+  case K_CONST_INT:
+    stream << indent(n) << "Const_int\n";
+    stream << indent(n+2) << "(name)\n";
+    stream << indent(n+2) << inttable.lookup(a[id]) << endl;
+    dump_type(stream, id, n);
+    break;
+  case K_CONST_STRING:
+    stream << indent(n) << "Const_string\n";
+    stream << indent(n+2) << "(name)\n";
+    stream << indent(n+2) << stringtable.lookup(a[id]) << endl;
+    dump_type(stream, id, n);
+    break;
+  case K_CONST_FLOAT:
+    stream << indent(n) << "Const_float\n";
+    stream << indent(n+2) << "(name)\n";
+    stream << indent(n+2) << floattable.lookup(a[id]) << endl;
+    dump_type(stream, id, n);
+    break;
+  case K_CONST_BOOL:
+    stream << indent(n) << "Const_bool\n";
+    stream << indent(n+2) << "(name)\n";
+    stream << indent(n+2) << (int) a[id] << "\n";
+    dump_type(stream, id, n);
+    break;
+  case K_NO_EXPR:
+    stream << indent(n) << "No_expr\n";
+    break;
+  case K_LIST:
+    dump_list(stream, id, n);
+    break;
+  }
+}
+
+//
+// recheck_operator_types applies the rules of operator-rules.h, the
+// same ones the checker in semant.cc uses, in one pass over the nodes.
+// Leaves (constants, objects, calls, assignments) keep the type the
+// checker gave them; the type of every operator is derived again from
+// the derived types of its operands, which the post-order numbering
+// guarantees were computed first.  Returns the number of operators
+// whose stored type differs from the derived one.
+//
+static unsigned int type_index(char *name)
+{
+  Symbol s = idtable.lookup_string(name);
+  return s ? s->get_index() : NO_ID;
+}
+
+static TypeId type_id(unsigned int index)
+{
+  return index == NO_ID ? TY_NONE : idtable.lookup(index)->get_type_id();
+}
+
+int CompactAst::recheck_operator_types()
+{
+  const unsigned int Int = type_index("Int");
+  const unsigned int Float = type_index("Float");
+  const unsigned int Bool = type_index("Bool");
+
+  std::vector<unsigned int> derived(type);
+  int mismatches = 0;
+  int n = size();
+  for (int id = 0; id < n; id++) {
+    int k = kind[id];
+    if (!is_operator(k))
+      continue;
+    unsigned int l = derived[a[id]];
+    unsigned int r = is_unary_operator(k) ? l : derived[b[id]];
+    unsigned char outcome = operator_outcome(k, operand_class(type_id(l)),
+                                             operand_class(type_id(r)));
+    if ((outcome & SAME_ONLY) && l != r)
+      outcome = REJECTED;
+    unsigned int t = NO_ID;
+    switch (outcome & OUTCOME_TYPE) {
+    case T_OPERAND: t = l; break;
+    case T_FLOAT:   t = Float; break;
+    case T_BOOL:    t = Bool; break;
+    case T_INT:     t = Int; break;
+    }
+    derived[id] = t;
+    if (t != type[id])
+      mismatches++;
+  }
+  return mismatches;
+}
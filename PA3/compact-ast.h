@@ -0,0 +1,139 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef COMPACT_AST_H
+#define COMPACT_AST_H
+//////////////////////////////////////////////////////////////////////
+//
+//  compact-ast.h
+//
+//  CompactAst is a second, data-oriented representation of a Seal
+//  program.  Instead of one heap object per node it keeps a handful of
+//  parallel arrays indexed by a 32-bit NodeId:
+//
+//     kind[id]    what the node is (a NodeKind)
+//     line[id]    the source line the node came from
+//     type[id]    idtable index of the node's type, or NO_ID
+//     a[id]       first operand
+//     b[id]       second operand
+//
+//  Operands are either NodeIds of children or 32-bit symbol ids: the
+//  index of the Symbol in idtable, or in inttable, stringtable or
+//  floattable for the constant kinds.  Lists, and the nodes that have
+//  more than two operands (IfStmt, ForStmt and CallDecl), keep their
+//  operands contiguously in the lists array; a[id] is the position of
+//  the first one.  For a list node b[id] is the number of elements.
+//
+//  Node operands:
+//
+//     K_PROGRAM        a = list of decls
+//     K_VARIABLE       a = name, b = type
+//     K_VARIABLE_DECL  a = variable
+//     K_CALL_DECL      lists[a..a+3] = name, parameter list,
+//                      return type, body
+//     K_STMT_BLOCK     a = list of variable decls, b = list of stmts
+//     K_IF             lists[a..a+2] = condition, then, else
+//     K_WHILE          a = condition, b = body
+//     K_FOR            lists[a..a+3] = init, condition, loop, body
+//     K_RETURN         a = value
+//     K_ASSIGN         a = lvalue name, b = value
+//     binary ops       a = left, b = right
+//     unary ops        a = operand
+//     K_CONST_*        a = constant symbol (the value itself for bool)
+//     K_OBJECT         a = name
+//     K_CALL           a = name, b = list of actuals
+//     K_ACTUAL         a = expr
+//     K_LIST           lists[a..a+b-1] = elements
+//
+//  A CompactAst is built by lowering a finished class AST with
+//  Program_class::lower, which calls lower on every node bottom-up, so
+//  a child always has a smaller id than its parent and a single pass
+//  in id order visits every operand before the node that uses it.
+//
+//     NodeId add(kind, line, type, a, b)  append one node
+//     NodeId add_list(list)               lower the elements of an AST
+//                                         list and append a K_LIST
+//     int size()                          number of nodes
+//     size_t bytes()                      bytes held by the arrays
+//     void dump_with_types(stream, n)     same output as the class AST
+//     int recheck_operator_types()        recompute the type of every
+//                                         operator and count the nodes
+//                                         whose stored type disagrees
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "tree.h"
+#include "seal-tree.handcode.h"
+
+const unsigned int NO_ID = 0xffffffff;
+
+class CompactAst {
+private:
+  std::vector<NodeId> pending;   // lowered list elements not yet placed
+
+  void dump_node(DumpWriter& stream, NodeId id, int n);
+  void dump_type(DumpWriter& stream, NodeId id, int n);
+  void dump_list(DumpWriter& stream, NodeId list, int n);
+
+public:
+  std::vector<unsigned char> kind;
+  std::vector<int> line;
+  std::vector<unsigned int> type;
+  std::vector<unsigned int> a;
+  std::vector<unsigned int> b;
+  std::vector<NodeId> lists;
+  NodeId root;
+
+  CompactAst() : root(NO_ID) { }
+
+  NodeId add(NodeKind k, int l, unsigned int t,
+             unsigned int x = 0, unsigned int y = 0)
+  {
+    kind.push_back(k);
+    line.push_back(l);
+    type.push_back(t);
+    a.push_back(x);
+    b.push_back(y);
+    return kind.size() - 1;
+  }
+
+  // Store ops in lists and return the position of the first one.
+  unsigned int add_operands(std::initializer_list<unsigned int> ops)
+  {
+    unsigned int start = lists.size();
+    lists.insert(lists.end(), ops);
+    return start;
+  }
+
+  // Lowering an element may itself place lists, so the elements are
+  // collected on the pending stack and only copied into lists once
+  // the whole list has been lowered.
+  template <class Elem> NodeId add_list(list_node<Elem> *l)
+  {
+    size_t mark = pending.size();
+    for (Elem e : *l)
+      pending.push_back(e->lower(*this));
+    unsigned int start = lists.size();
+    lists.insert(lists.end(), pending.begin() + mark, pending.end());
+    pending.resize(mark);
+    return add(K_LIST, l->get_line_number(), NO_ID, start, l->len());
+  }
+
+  int size() const { return kind.size(); }
+  size_t bytes() const;
+
+  void dump_with_types(DumpWriter& stream, int n);
+  int recheck_operator_types();
+};
+
+// The idtable index of a symbol, or NO_ID for none.
+inline unsigned int symbol_id(Symbol s)
+{
+  return s ? s->get_index() : NO_ID;
+}
+
+#endif
@@ -0,0 +1,154 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  dump-writer.h
+//
+//  DumpWriter is the output stream of the AST dump routines.  It
+//  collects the dump in a large preallocated buffer and passes it on
+//  to an ostream a buffer at a time, so a whole dump costs a handful
+//  of ostream::write calls instead of several formatted insertions and
+//  a flush per line.
+//
+//     DumpWriter(ostream &out, size_t size)
+//       writes to out through a buffer of size bytes (default 1 MB).
+//
+//     w << "text" << 'c' << 42 << sym << indent(n) << endl
+//       appends a string, a character, an integer, the name of a
+//       Symbol, n spaces or a newline.  endl does not flush.
+//
+//     void flush()
+//       hands everything buffered to out and flushes out.  This is
+//       done once at the end of a dump, and by the destructor.
+//
+//  Unlike pad(n), indent(n) is not limited to 80 spaces.
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _DUMP_WRITER_H_
+#define _DUMP_WRITER_H_
+
+#include <string.h>
+#include "stringtab.h"
+#include "seal-io.h"
+
+struct Indent {
+  int n;
+};
+
+inline Indent indent(int n)
+{
+  Indent i = { n };
+  return i;
+}
+
+class DumpWriter {
+private:
+  ostream &out;
+  char *buf;
+  char *cur;           // next free byte in buf
+  char *end;           // one past the last byte of buf
+
+  DumpWriter(const DumpWriter &);           // not copyable
+  DumpWriter &operator =(const DumpWriter &);
+
+  // Hand the buffered bytes to out, without flushing out.
+  void drain()
+  {
+    out.write(buf, cur - buf);
+    cur = buf;
+  }
+
+public:
+  DumpWriter(ostream &o, size_t size = 1 << 20) : out(o)
+  {
+    buf = new char[size];
+    cur = buf;
+    end = buf + size;
+  }
+
+  ~DumpWriter()
+  {
+    flush();
+    delete[] buf;
+  }
+
+  void write(const char *s, size_t n)
+  {
+    if ((size_t) (end - cur) < n) {
+      drain();
+      if ((size_t) (end - buf) < n) {
+        out.write(s, n);
+        return;
+      }
+    }
+    memcpy(cur, s, n);
+    cur += n;
+  }
+
+  void flush()
+  {
+    drain();
+    out.flush();
+  }
+
+  DumpWriter &operator <<(const char *s)
+  {
+    write(s, strlen(s));
+    return *this;
+  }
+
+  DumpWriter &operator <<(char c)
+  {
+    if (cur == end)
+      drain();
+    *cur++ = c;
+    return *this;
+  }
+
+  DumpWriter &operator <<(int i)
+  {
+    char digits[12];
+    char *p = digits + sizeof(digits);
+    unsigned int u = i < 0 ? 0u - (unsigned int) i : (unsigned int) i;
+    do {
+      *--p = '0' + u % 10;
+      u /= 10;
+    } while (u != 0);
+    if (i < 0)
+      *--p = '-';
+    write(p, digits + sizeof(digits) - p);
+    return *this;
+  }
+
+  DumpWriter &operator <<(Symbol sym)
+  {
+    write(sym->get_string(), sym->get_len());
+    return *this;
+  }
+
+  DumpWriter &operator <<(Indent in)
+  {
+    for (int n = in.n; n > 0; ) {
+      if (cur == end)
+        drain();
+      int k = end - cur < n ? end - cur : n;
+      memset(cur, ' ', k);
+      cur += k;
+      n -= k;
+    }
+    return *this;
+  }
+
+  // Manipulators such as endl; all of them just end the line.
+  DumpWriter &operator <<(ostream &(*)(ostream &))
+  {
+    return *this << '\n';
+  }
+};
+
+#endif
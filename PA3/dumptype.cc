@@ -12,10 +12,10 @@
 #include "utilities.h"
 
 // defined in stringtab.cc
-void dump_Symbol(ostream& stream, int padding, Symbol b); 
+void dump_Symbol(DumpWriter& stream, int padding, Symbol b); 
 
 // defined in seal.h
-void dump_Boolean(ostream& stream, int padding, Boolean b);
+void dump_Boolean(DumpWriter& stream, int padding, Boolean b);
 
 //////////////////////////////////////////////////////////////////
 //
@@ -27,7 +27,7 @@ void dump_Boolean(ostream& stream, int padding, Boolean b);
 //  type inference.
 //
 //  dump_with_types takes two argumenmts:
-//     an output stream
+//     a DumpWriter, the buffered output (see dump-writer.h)
 //     an indentation "n", the number of blanks to insert at the beginning of
 //                         a new line.
 //   
@@ -114,451 +114,451 @@ void dump_Boolean(ostream& stream, int padding, Boolean b);
 //
 //
 
-void Expr_class::dump_type(ostream& stream, int n)
+void Expr_class::dump_type(DumpWriter& stream, int n)
 {
   if (type)
-    { stream << pad(n) << ": " << type << endl; }
+    { stream << indent(n) << ": " << type << endl; }
   else
-    { stream << pad(n) << ": _no_type" << endl; }
+    { stream << indent(n) << ": _no_type" << endl; }
 }
 
 
-void Call_class::dump_type(ostream& stream, int n)
+void Call_class::dump_type(DumpWriter& stream, int n)
 {
   if (type)
-    { stream << pad(n) << ": " << type << endl; }
+    { stream << indent(n) << ": " << type << endl; }
   else
-    { stream << pad(n) << ": _no_type" << endl; }
+    { stream << indent(n) << ": _no_type" << endl; }
 }
 
-void Actual_class::dump_type(ostream& stream, int n)
+void Actual_class::dump_type(DumpWriter& stream, int n)
 {
   if (type)
-    { stream << pad(n) << ": " << type << endl; }
+    { stream << indent(n) << ": " << type << endl; }
   else
-    { stream << pad(n) << ": _no_type" << endl; }
+    { stream << indent(n) << ": _no_type" << endl; }
 }
 
-void dump_line(ostream& stream, int n, tree_node *t)
+void dump_line(DumpWriter& stream, int n, tree_node *t)
 {
-  stream << pad(n) << "#" << t->get_line_number() << "\n";
+  stream << indent(n) << "#" << t->get_line_number() << "\n";
 }
 
 //
 //  program_class prints "program" and then each of the
 //  component classes of the program, one at a time, at a
 //  greater indentation. The recursive invocation on
-//  "classes->nth(i)->dump_with_types(...)" shows how useful
+//  "decl->dump_with_types(...)" shows how useful
 //  and compact virtual functions are for this kind of computation.
 //
-//  Note the use of the iterator to cycle through all of the
-//  classes.  The methods first, more, next, and nth on AST lists
-//  are defined in tree.h.
+//  Note the use of the range-based for loop to cycle through all of
+//  the declarations.  The methods begin and end on AST lists are
+//  defined in tree.h.
 //
-void Program_class::dump_with_types(ostream& stream, int n)
+void Program_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Program\n";
-   for(int i = decls->first(); decls->more(i); i = decls->next(i)){
-      decls->nth(i)->dump_with_types(stream, n+2);
+   stream << indent(n) << "Program\n";
+   for(Decl decl : *decls){
+      decl->dump_with_types(stream, n+2);
    }
      
 }
 
-void VariableDecl_class::dump_with_types(ostream& stream, int n)
+void VariableDecl_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Variable Declaration\n";
+   stream << indent(n) << "Variable Declaration\n";
    variable->dump_with_types(stream, n+2);
 }
 
-void Variable_class::dump_with_types(ostream& stream, int n)
+void Variable_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Variable\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Variable\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, name);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_Symbol(stream, n+2, type);
 }
 
 
-void CallDecl_class::dump_with_types(ostream& stream, int n)
+void CallDecl_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Call Declaration\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Call Declaration\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, name);
-   stream << pad(n+2) << "(parameters)\n";
-   stream << pad(n+2) << "(\n";
-   for(int i = paras->first(); paras->more(i); i = paras->next(i))
-     paras->nth(i)->dump_with_types(stream, n+2);
-   stream << pad(n+2) << ")\n";
-   stream << pad(n+2) << "(return type)\n";
+   stream << indent(n+2) << "(parameters)\n";
+   stream << indent(n+2) << "(\n";
+   for(Variable para : *paras)
+     para->dump_with_types(stream, n+2);
+   stream << indent(n+2) << ")\n";
+   stream << indent(n+2) << "(return type)\n";
    dump_Symbol(stream, n+2, returnType);
-   stream << pad(n+2) << "(body)\n";
+   stream << indent(n+2) << "(body)\n";
    body->dump_with_types(stream, n+2);
    
 }
 
-void StmtBlock_class::dump_with_types(ostream& stream, int n)
+void StmtBlock_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Statement Block\n";
-   stream << pad(n+2) << "(variable declarations)\n";
-   stream << pad(n+2) << "(\n";
-   for(int i = vars->first(); vars->more(i); i = vars->next(i))
-     vars->nth(i)->dump_with_types(stream, n+2);
-   stream << pad(n+2) << ")\n";
-   stream << pad(n+2) << "(statements)\n";
-   stream << pad(n+2) << "(\n";
-   for(int i = stmts->first(); stmts->more(i); i = stmts->next(i))
-     stmts->nth(i)->dump_with_types(stream, n+2);
-   stream << pad(n+2) << ")\n";
+   stream << indent(n) << "Statement Block\n";
+   stream << indent(n+2) << "(variable declarations)\n";
+   stream << indent(n+2) << "(\n";
+   for(VariableDecl var : *vars)
+     var->dump_with_types(stream, n+2);
+   stream << indent(n+2) << ")\n";
+   stream << indent(n+2) << "(statements)\n";
+   stream << indent(n+2) << "(\n";
+   for(Stmt stmt : *stmts)
+     stmt->dump_with_types(stream, n+2);
+   stream << indent(n+2) << ")\n";
 }
 
-void IfStmt_class::dump_with_types(ostream& stream, int n)
+void IfStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "IfStmt\n";
-   stream << pad(n+2) << "(condition)\n";
+   stream << indent(n) << "IfStmt\n";
+   stream << indent(n+2) << "(condition)\n";
    condition->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(then)\n";
+   stream << indent(n+2) << "(then)\n";
    thenexpr->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(else)\n";
+   stream << indent(n+2) << "(else)\n";
    elseexpr->dump_with_types(stream, n+2); 
 }
 
-void WhileStmt_class::dump_with_types(ostream& stream, int n)
+void WhileStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "WhileStmt\n";
-   stream << pad(n+2) << "(condition)\n";
+   stream << indent(n) << "WhileStmt\n";
+   stream << indent(n+2) << "(condition)\n";
    condition->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(body)\n";
+   stream << indent(n+2) << "(body)\n";
    body->dump_with_types(stream, n+2);
 }
 
-void ForStmt_class::dump_with_types(ostream& stream, int n)
+void ForStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "ForStmt\n";
-   stream << pad(n+2) << "(init)\n";
+   stream << indent(n) << "ForStmt\n";
+   stream << indent(n+2) << "(init)\n";
    initexpr->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(condition)\n";
+   stream << indent(n+2) << "(condition)\n";
    condition->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(loop)\n";
+   stream << indent(n+2) << "(loop)\n";
    loopact->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(body)\n";
+   stream << indent(n+2) << "(body)\n";
    body->dump_with_types(stream, n+2);
 }
 
-void BreakStmt_class::dump_with_types(ostream& stream, int n)
+void BreakStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "BreakStmt\n";
+   stream << indent(n) << "BreakStmt\n";
 }
 
 
-void ContinueStmt_class::dump_with_types(ostream& stream, int n)
+void ContinueStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "ContinueStmt\n";
+   stream << indent(n) << "ContinueStmt\n";
 }
 
-void ReturnStmt_class::dump_with_types(ostream& stream, int n)
+void ReturnStmt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "ReturnStmt\n";
-   stream << pad(n+2) << "(return value)\n";
+   stream << indent(n) << "ReturnStmt\n";
+   stream << indent(n+2) << "(return value)\n";
    value->dump_with_types(stream, n+2);
 }
 
-void Assign_class::dump_with_types(ostream& stream, int n)
+void Assign_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Assign\n";
-   stream << pad(n+2) << "(left value)\n";
+   stream << indent(n) << "Assign\n";
+   stream << indent(n+2) << "(left value)\n";
    dump_Symbol(stream, n+2, lvalue);
-   stream << pad(n+2) << "(right value)\n";
+   stream << indent(n+2) << "(right value)\n";
    value->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Add_class::dump_with_types(ostream& stream, int n)
+void Add_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "+\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "+\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Minus_class::dump_with_types(ostream& stream, int n)
+void Minus_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "-\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "-\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Multi_class::dump_with_types(ostream& stream, int n)
+void Multi_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "*\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "*\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
-void Divide_class::dump_with_types(ostream& stream, int n)
+void Divide_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "/\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "/\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
-void Mod_class::dump_with_types(ostream& stream, int n)
+void Mod_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "%\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "%\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
-void Neg_class::dump_with_types(ostream& stream, int n)
+void Neg_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "-\n";
-   stream << pad(n+2) << "(OP)\n";
+   stream << indent(n) << "-\n";
+   stream << indent(n+2) << "(OP)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
-void Lt_class::dump_with_types(ostream& stream, int n)
+void Lt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "<\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "<\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
-void Le_class::dump_with_types(ostream& stream, int n)
+void Le_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "<=\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "<=\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Equ_class::dump_with_types(ostream& stream, int n)
+void Equ_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "==\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "==\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Neq_class::dump_with_types(ostream& stream, int n)
+void Neq_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "!=\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "!=\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Ge_class::dump_with_types(ostream& stream, int n)
+void Ge_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << ">=\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << ">=\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Gt_class::dump_with_types(ostream& stream, int n)
+void Gt_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << ">\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << ">\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void And_class::dump_with_types(ostream& stream, int n)
+void And_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "&&\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "&&\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Or_class::dump_with_types(ostream& stream, int n)
+void Or_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "||\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "||\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Xor_class::dump_with_types(ostream& stream, int n)
+void Xor_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "^\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "^\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Not_class::dump_with_types(ostream& stream, int n)
+void Not_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "!\n";
-   stream << pad(n+2) << "(OP)\n";
+   stream << indent(n) << "!\n";
+   stream << indent(n+2) << "(OP)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Bitand_class::dump_with_types(ostream& stream, int n)
+void Bitand_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "&\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "&\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
-void Bitor_class::dump_with_types(ostream& stream, int n)
+void Bitor_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "|\n";
-   stream << pad(n+2) << "(OP left)\n";
+   stream << indent(n) << "|\n";
+   stream << indent(n+2) << "(OP left)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(OP right)\n";
+   stream << indent(n+2) << "(OP right)\n";
    e2->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
 
-void Bitnot_class::dump_with_types(ostream& stream, int n)
+void Bitnot_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "~\n";
-   stream << pad(n+2) << "(OP)\n";
+   stream << indent(n) << "~\n";
+   stream << indent(n+2) << "(OP)\n";
    e1->dump_with_types(stream, n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
 }
 
-void Object_class::dump_with_types(ostream& stream, int n)
+void Object_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Object\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Object\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, var);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
 
-void Call_class::dump_with_types(ostream& stream, int n)
+void Call_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Call\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Call\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, name);
-   stream << pad(n+2) << "(actual parameters)\n";
-   stream << pad(n+2) << "(\n";
-   for(int i = actuals->first(); actuals->more(i); i = actuals->next(i))
-     actuals->nth(i)->dump_with_types(stream, n+2);
-   stream << pad(n+2) << ")\n";
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(actual parameters)\n";
+   stream << indent(n+2) << "(\n";
+   for(Actual actual : *actuals)
+     actual->dump_with_types(stream, n+2);
+   stream << indent(n+2) << ")\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Actual_class::dump_with_types(ostream& stream, int n)
+void Actual_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Actual\n";
-   stream << pad(n+2) << "(expr)\n";
+   stream << indent(n) << "Actual\n";
+   stream << indent(n+2) << "(expr)\n";
    expr->dump_with_types(stream,n+2);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Const_int_class::dump_with_types(ostream& stream, int n)
+void Const_int_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Const_int\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Const_int\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, value);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Const_string_class::dump_with_types(ostream& stream, int n)
+void Const_string_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Const_string\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Const_string\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, value);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Const_float_class::dump_with_types(ostream& stream, int n)
+void Const_float_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Const_float\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Const_float\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Symbol(stream, n+2, value);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void Const_bool_class::dump_with_types(ostream& stream, int n)
+void Const_bool_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "Const_bool\n";
-   stream << pad(n+2) << "(name)\n";
+   stream << indent(n) << "Const_bool\n";
+   stream << indent(n+2) << "(name)\n";
    dump_Boolean(stream, n+2, value);
-   stream << pad(n+2) << "(type)\n";
+   stream << indent(n+2) << "(type)\n";
    dump_type(stream,n);
 }
 
-void No_expr_class::dump_with_types(ostream& stream, int n)
+void No_expr_class::dump_with_types(DumpWriter& stream, int n)
 {
    dump_line(stream,n,this);
-   stream << pad(n) << "No_expr\n";
+   stream << indent(n) << "No_expr\n";
 }
\ No newline at end of file
@@ -8,7 +8,10 @@
 #include <stdlib.h>
 #include "seal-io.h"
 #include <unistd.h>
+#include <string.h>
 #include "cgen_gc.h"
+#include "phase-report.h"
+#include "semant-diag.h"
 
 //
 // sealc provides a debugging switch for each phase of the compiler,
@@ -30,6 +33,18 @@ extern int seal_yydebug;        // for the parser
        bool disable_reg_alloc;  // Don't do register allocation
 
        int cgen_optimize;       // optimize switch for code generator 
+       int binary_ast_output;   // write the typed AST in binary (binary-ast.h)
+       int mapped_input;        // lex a memory map of the input (source-map.h)
+       int batch_jobs;          // worker threads for a batch (batch.h), 0 for one per core, -1 without -j
+       int phase_report;        // report time and memory per phase (phase-report.h)
+       int execute_program;     // run the program on the bytecode VM (bytecode.h)
+       int assembly_output;     // write x86-64 assembly (x86-cgen.h)
+       int c_output;            // write the program as C (c-cgen.h)
+       int semant_threads;      // threads checking function bodies, or 0 for one per core
+       char *semant_cache_dir;  // where to cache checked functions (semant-cache.h), or NULL
+       int diagnostic_format;   // how semant prints its errors (semant-diag.h)
+       int error_limit;         // stop checking after this many errors, or 0
+       int sort_diagnostics;    // sort semant's errors by line and drop repeats
        char *out_filename;      // file name for generated code
        Memmgr cgen_Memmgr = GC_NOGC;      // enable/disable garbage collection
        Memmgr_Test cgen_Memmgr_Test = GC_NORMAL;  // normal/test GC
@@ -51,9 +66,21 @@ void handle_flags(int argc, char *argv[]) {
   cgen_debug = 0;
   cgen_optimize = 0;
   disable_reg_alloc = 0;
+  binary_ast_output = 0;
+  mapped_input = 0;
+  batch_jobs = -1;
+  phase_report = REPORT_NONE;
+  execute_program = 0;
+  assembly_output = 0;
+  c_output = 0;
+  semant_threads = 1;
+  semant_cache_dir = NULL;
+  diagnostic_format = DIAG_TEXT;
+  error_limit = 0;
+  sort_diagnostics = 0;
   
 
-  while ((c = getopt(argc, argv, "lpscvrOo:gtT")) != -1) {
+  while ((c = getopt(argc, argv, "lpscvrOo:gtTBmj:R:xSCP:k:D:e:U")) != -1) {
     switch (c) {
 #ifdef DEBUG
     case 'l':
@@ -99,6 +126,58 @@ void handle_flags(int argc, char *argv[]) {
     case 'O':  // enable optimization
       cgen_optimize = 1;
       break;
+    case 'B':  // write the typed AST in binary instead of as text
+      binary_ast_output = 1;
+      break;
+    case 'm':  // scan the input in place through mmap instead of fread
+      mapped_input = 1;
+      break;
+    case 'j':  // compile the inputs as a batch on this many threads, 0 for one per core
+      batch_jobs = atoi(optarg);
+      if (batch_jobs < 0)
+        unknownopt = 1;
+      break;
+    case 'R':  // report time and memory per phase, as text or json
+      if (strcmp(optarg, "text") == 0)
+        phase_report = REPORT_TEXT;
+      else if (strcmp(optarg, "json") == 0)
+        phase_report = REPORT_JSON;
+      else
+        unknownopt = 1;
+      break;
+    case 'x':  // run the checked program instead of dumping its AST
+      execute_program = 1;
+      break;
+    case 'S':  // write the checked program as x86-64 assembly
+      assembly_output = 1;
+      break;
+    case 'C':  // write the checked program as C
+      c_output = 1;
+      break;
+    case 'P':  // check function bodies on this many threads
+      semant_threads = atoi(optarg);
+      if (semant_threads < 0)
+        unknownopt = 1;
+      break;
+    case 'k':  // reuse the checks of unchanged functions from this directory
+      semant_cache_dir = optarg;
+      break;
+    case 'D':  // print semant's errors as text or json
+      if (strcmp(optarg, "text") == 0)
+        diagnostic_format = DIAG_TEXT;
+      else if (strcmp(optarg, "json") == 0)
+        diagnostic_format = DIAG_JSON;
+      else
+        unknownopt = 1;
+      break;
+    case 'e':  // stop checking after this many errors
+      error_limit = atoi(optarg);
+      if (error_limit < 1)
+        unknownopt = 1;
+      break;
+    case 'U':  // sort semant's errors by line and drop repeats
+      sort_diagnostics = 1;
+      break;
     case '?':
       unknownopt = 1;
       break;
@@ -111,9 +190,9 @@ void handle_flags(int argc, char *argv[]) {
   if (unknownopt) {
       cerr << "usage: " << argv[0] << 
 #ifdef DEBUG
-	  " [-lvpscOgtTr -o outname] [input-files]\n";
+	  " [-lvpscOgtTrBmxSCU -j jobs -P threads -k cachedir -e errors -D text|json -R text|json -o outname] [input-files | @response-file]\n";
 #else
-      " [-OgtT -o outname] [input-files]\n";
+      " [-OgtTBmxSCU -j jobs -P threads -k cachedir -e errors -D text|json -R text|json -o outname] [input-files | @response-file]\n";
 #endif
       exit(1);
   }
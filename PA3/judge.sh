@@ -11,5 +11,15 @@ for filename in *.seal; do
         echo NOT passed
     fi
 done
+echo "--------Test using -j 2 -D json on all files--------"
+../semant -j 2 -D json *.seal 2> tempfile > /dev/null
+# every line of stderr must be a JSON object
+diff tempfile ../test-answer/batch-json.out > /dev/null &&
+    ! grep -qv '^{.*}$' tempfile
+if [ $? -eq 0 ]; then
+    echo "Passed"
+else
+    echo NOT passed
+fi
 rm -f tempfile
 cd ..
@@ -0,0 +1,127 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  lex_bench.cc
+//
+//  Runs the lexer over a Seal file to the end, first reading it with
+//  fread through YY_INPUT and then scanning a SourceMap of it in place,
+//  and reports the throughput of each.  The two token streams are
+//  checked to be the same: a checksum over the token codes, lines and
+//  interned symbols must agree.
+//
+//  usage: lex_bench file [rounds]
+//
+//  rounds (default 5) is the number of times each input path is timed;
+//  the best round is reported.  The time to open and map the file is
+//  included in the mapped rounds.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <time.h>
+#include "seal-decl.h"
+#include "seal-expr.h"
+#include "seal-stmt.h"
+#include "seal-parse.h"
+#include "source-map.h"
+
+thread_local FILE *fin;       // input file
+extern int optind;  // used for option processing (man 3 getopt for more info)
+thread_local char *curr_filename = "<stdin>";
+int seal_yylex(void);
+
+void handle_flags(int argc, char *argv[]);
+
+static double seconds_since(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static bool has_symbol(int code)
+{
+  return code == CONST_INT || code == CONST_FLOAT || code == CONST_STRING ||
+         code == OBJECTID || code == TYPEID;
+}
+
+// Lex the input seal_lex_begin was pointed at, to the end.  Returns
+// the number of tokens; sum is set to a checksum of them.
+static long lex_all(unsigned long &sum)
+{
+  long tokens = 0;
+  sum = 0;
+  curr_lineno = 1;
+  int code;
+  while ((code = seal_yylex()) != 0) {
+    unsigned long value = has_symbol(code) ?
+                          (unsigned long) seal_yylval.symbol : 0;
+    sum = (sum ^ code ^ ((unsigned long) curr_lineno << 8) ^ value) *
+          1099511628211ul;
+    tokens++;
+  }
+  return tokens;
+}
+
+int main(int argc, char *argv[]) {
+  handle_flags(argc, argv);
+  if (optind >= argc) {
+    cerr << "usage: lex_bench file [rounds]\n";
+    exit(1);
+  }
+  char *filename = argv[optind];
+  int rounds = optind + 1 < argc ? atoi(argv[optind + 1]) : 5;
+  long read_tokens = 0, mapped_tokens = 0;
+  unsigned long read_sum = 0, mapped_sum = 0;
+
+  double read_best = 1e30;
+  for (int r = 0; r < rounds; r++) {
+    clock_t start = clock();
+    fin = fopen(filename, "r");
+    if (fin == NULL) {
+      cerr << "Could not open input file " << filename << endl;
+      exit(1);
+    }
+    seal_lex_begin(NULL, 0);
+    read_tokens = lex_all(read_sum);
+    seal_lex_end();
+    fclose(fin);
+    double t = seconds_since(start);
+    if (t < read_best)
+      read_best = t;
+  }
+
+  double mapped_best = 1e30;
+  size_t bytes = 0;
+  for (int r = 0; r < rounds; r++) {
+    clock_t start = clock();
+    SourceMap src;
+    if (!src.open(filename)) {
+      cerr << "Could not map input file " << filename << endl;
+      exit(1);
+    }
+    seal_lex_begin(src.buffer(), src.buffer_size());
+    mapped_tokens = lex_all(mapped_sum);
+    seal_lex_end();
+    double t = seconds_since(start);
+    if (t < mapped_best)
+      mapped_best = t;
+    bytes = src.size();
+  }
+
+  if (read_tokens != mapped_tokens || read_sum != mapped_sum) {
+    cerr << "error: mapped input gives different tokens\n";
+    exit(1);
+  }
+
+  double mb = bytes / 1e6;
+  cout << read_tokens << " tokens, " << mb << " MB\n";
+  cout << "  fread:  " << read_best << " s (" << mb / read_best
+       << " MB/s)\n";
+  cout << "  mapped: " << mapped_best << " s (" << mb / mapped_best
+       << " MB/s)\n";
+  return 0;
+}
@@ -0,0 +1,189 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef OPERATOR_RULES_H
+#define OPERATOR_RULES_H
+//////////////////////////////////////////////////////////////////////
+//
+//  operator-rules.h
+//
+//  The typing rules of the Seal operators, one row per operator kind
+//  from K_ADD to K_BITNOT.  Both the type checker (semant.cc) and the
+//  compact AST (compact-ast.cc) read them from here.
+//
+//  A rule says which operand types an operator accepts and what type
+//  the result has.  Operand types are classified into OperandClass, by
+//  operand_class from their TypeId (type-id.h), so that the table does
+//  not depend on the Symbols of a particular run.  A unary operator is
+//  checked as if both its operands were the same.
+//
+//     accepts          a set of the following:
+//       A_SAME           both operands have the same type
+//       A_NUMERIC        both operands are Int or Float
+//       A_BOOL           both operands are Bool
+//       A_INT            both operands are Int
+//     result
+//       R_OPERAND        the operand type; Float if one operand is
+//                        Int and the other Float
+//       R_BOOL           Bool
+//       R_INT            Int
+//     typed_on_error   the result type is assigned even when the
+//                      operands are not accepted
+//
+//  The rules are expanded at compile time into operator_outcomes, which
+//  gives the outcome of every operator for every pair of operand
+//  classes, so checking an operator is a single table lookup:
+//
+//     unsigned char o = operator_outcome(kind, operand_class(left),
+//                                        operand_class(right));
+//
+//  The low bits of o say what the result type is (an OutcomeType); the
+//  REJECTED bit is set if an error must be reported.  OC_OTHER lumps
+//  String, Void and untyped operands together, so for two OC_OTHER
+//  operands the SAME_ONLY bit says that the outcome holds only if the
+//  two types are equal and the operator rejects them otherwise.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "seal-tree.handcode.h"
+#include "type-id.h"
+
+enum OperandClass { OC_INT, OC_FLOAT, OC_BOOL, OC_OTHER };
+
+constexpr OperandClass operand_class(TypeId t)
+{
+  return t == TY_INT ? OC_INT : t == TY_FLOAT ? OC_FLOAT :
+         t == TY_BOOL ? OC_BOOL : OC_OTHER;
+}
+
+enum { A_SAME = 1, A_NUMERIC = 2, A_BOOL = 4, A_INT = 8 };
+
+enum RuleResult { R_OPERAND, R_BOOL, R_INT };
+
+struct OperatorRule {
+  const char *name;           // as printed by dump
+  unsigned char accepts;
+  RuleResult result;
+  bool typed_on_error;
+  const char *error;          // reported when the operands are rejected
+};
+
+constexpr OperatorRule operator_rules[] = {
+  { "+",  A_SAME | A_NUMERIC, R_OPERAND, false,
+    "two expressions in add should have same type" },
+  { "-",  A_SAME | A_NUMERIC, R_OPERAND, false,
+    "two expressions in minus should have same type" },
+  { "*",  A_SAME | A_NUMERIC, R_OPERAND, false,
+    "two expressions in multi should have same type" },
+  { "/",  A_SAME | A_NUMERIC, R_OPERAND, false,
+    "two expressions in divide should have same type" },
+  { "%",  A_SAME | A_NUMERIC, R_OPERAND, false,
+    "two expressions should in mod have same type" },
+  { "<",  A_NUMERIC, R_BOOL, true, "Value Type should be Int or Float" },
+  { "<=", A_NUMERIC, R_BOOL, true, "Value Type should be Int or Float" },
+  { "==", A_NUMERIC | A_BOOL, R_BOOL, true,
+    "Bool equation calculation Type Error" },
+  { "!=", A_NUMERIC | A_BOOL, R_BOOL, true,
+    "Bool Nonequation calculation Type Error" },
+  { ">=", A_NUMERIC, R_BOOL, true, "Value Type should be Int or Float" },
+  { ">",  A_NUMERIC, R_BOOL, true, "Value Type should be Int or Float" },
+  { "&&", A_BOOL, R_BOOL, false,
+    "logical calc values should have type Bool" },
+  { "||", A_BOOL, R_BOOL, false,
+    "logical calc values should have type Bool" },
+  { "^",  A_BOOL | A_INT, R_OPERAND, false, "xor calculation wrong type!" },
+  { "&",  A_INT, R_INT, false, "Bit calculation should have type Int" },
+  { "|",  A_INT, R_INT, false, "Bit calculation should have type Int" },
+  { "-",  A_NUMERIC, R_OPERAND, true, "TypeError" },
+  { "!",  A_BOOL, R_BOOL, false, "Not calc should have type Bool" },
+  { "~",  A_INT, R_INT, false, "Bit calculation should have type Int" },
+};
+
+static_assert(sizeof(operator_rules) / sizeof(operator_rules[0]) ==
+              K_BITNOT - K_ADD + 1, "one rule per operator kind");
+
+constexpr bool is_operator(int kind)
+{
+  return kind >= K_ADD && kind <= K_BITNOT;
+}
+
+constexpr bool is_unary_operator(int kind)
+{
+  return kind >= K_NEG && kind <= K_BITNOT;
+}
+
+constexpr const OperatorRule &operator_rule(int kind)
+{
+  return operator_rules[kind - K_ADD];
+}
+
+constexpr bool is_numeric(OperandClass c)
+{
+  return c == OC_INT || c == OC_FLOAT;
+}
+
+// same is true when the two operand types are the same type.
+constexpr bool rule_accepts(const OperatorRule &rule, OperandClass l,
+                            OperandClass r, bool same)
+{
+  return ((rule.accepts & A_SAME) && same) ||
+         ((rule.accepts & A_NUMERIC) && is_numeric(l) && is_numeric(r)) ||
+         ((rule.accepts & A_BOOL) && l == OC_BOOL && r == OC_BOOL) ||
+         ((rule.accepts & A_INT) && l == OC_INT && r == OC_INT);
+}
+
+enum OutcomeType { T_NONE, T_OPERAND, T_FLOAT, T_BOOL, T_INT };
+
+const unsigned char OUTCOME_TYPE = 0x0f;
+const unsigned char REJECTED     = 0x10;
+const unsigned char SAME_ONLY    = 0x20;
+
+constexpr unsigned char rule_outcome(const OperatorRule &rule,
+                                     OperandClass l, OperandClass r)
+{
+  unsigned char type = rule.result == R_BOOL ? T_BOOL :
+                       rule.result == R_INT ? T_INT :
+                       l == r ? T_OPERAND : T_FLOAT;
+  if (rule_accepts(rule, l, r, l == r && l != OC_OTHER))
+    return type;
+  if (l == OC_OTHER && r == OC_OTHER && rule_accepts(rule, l, r, true))
+    return type | SAME_ONLY;
+  return rule.typed_on_error ? type | REJECTED : T_NONE | REJECTED;
+}
+
+const int NUM_OPERATORS = K_BITNOT - K_ADD + 1;
+const int NUM_CLASSES = OC_OTHER + 1;
+
+struct OutcomeTable {
+  unsigned char outcome[NUM_OPERATORS][NUM_CLASSES][NUM_CLASSES];
+
+  constexpr OutcomeTable() : outcome()
+  {
+    for (int op = 0; op < NUM_OPERATORS; op++)
+      for (int l = 0; l < NUM_CLASSES; l++)
+        for (int r = 0; r < NUM_CLASSES; r++)
+          outcome[op][l][r] = rule_outcome(operator_rules[op],
+                                           (OperandClass) l,
+                                           (OperandClass) r);
+  }
+};
+
+constexpr OutcomeTable operator_outcomes;
+
+inline unsigned char operator_outcome(int kind, OperandClass l,
+                                      OperandClass r)
+{
+  return operator_outcomes.outcome[kind - K_ADD][l][r];
+}
+
+static_assert(operator_outcomes.outcome[K_ADD - K_ADD][OC_INT][OC_FLOAT] ==
+              T_FLOAT, "Int + Float is Float");
+static_assert(operator_outcomes.outcome[K_AND - K_ADD][OC_BOOL][OC_INT] ==
+              REJECTED, "Bool && Int is rejected");
+static_assert(operator_outcomes.outcome[K_LT - K_ADD][OC_BOOL][OC_INT] ==
+              (REJECTED | T_BOOL), "Bool < Int is rejected but Bool");
+
+#endif
@@ -0,0 +1,71 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  parse-context.cc
+//
+//  ParseContext::parse points this thread's scanner and parser state
+//  at one compilation, runs the parser, and collects the result.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "parse-context.h"
+#include "source-map.h"
+#include "tree.h"
+#include "utilities.h"
+#include "phase-report.h"
+
+extern thread_local FILE *fin;            // the scanner's input
+extern thread_local char *curr_filename;  // for diagnostics
+extern thread_local int node_lineno;      // line of the next tree node
+extern thread_local Program ast_root;     // set by the parser
+extern thread_local int omerrs;           // counted by the parser
+extern int seal_yyparse(void);
+
+bool ParseContext::parse()
+{
+  fin = fopen(filename, "r");
+  if (fin == NULL)
+    return false;
+  SourceMap src;
+  if (mapped && src.open(filename))
+    seal_lex_begin(src.buffer(), src.buffer_size());
+  else
+    seal_lex_begin(NULL, 0);
+
+  Arena *saved_arena = ast_arena;
+  ast_arena = &arena;
+  curr_filename = filename;
+  curr_lineno = 1;
+  node_lineno = 1;
+  ::ast_root = NULL;
+  ::omerrs = 0;
+
+  try {
+    PhaseTimer timer(PHASE_PARSE);
+    seal_yyparse();
+  } catch (CompilationAborted &) {
+    // A batch file gave up (see abort_compilation): put this thread's
+    // state back so the next file starts clean, and pass it on.
+    finish(saved_arena);
+    throw;
+  }
+
+  ast_root = ::ast_root;
+  errors = ::omerrs;
+  finish(saved_arena);
+  return true;
+}
+
+void ParseContext::finish(Arena *saved_arena)
+{
+  ast_arena = saved_arena;
+  seal_lex_end();
+  fclose(fin);
+  fin = NULL;
+}
@@ -0,0 +1,70 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef PARSE_CONTEXT_H
+#define PARSE_CONTEXT_H
+//////////////////////////////////////////////////////////////////////
+//
+//  parse-context.h
+//
+//  A ParseContext is one compilation: an input file, the arena its
+//  tree is allocated from, and the result of parsing it.  The scanner
+//  and parser keep their state (the flex buffers, yylval, curr_lineno,
+//  ast_root, omerrs, ...) in thread_local variables, so any number of
+//  threads can each parse a context of their own at the same time.
+//
+//     ParseContext(char *filename, bool mapped)
+//       a compilation of filename.  If mapped, the file is scanned in
+//       place through a SourceMap (see source-map.h) when possible.
+//
+//     bool parse()
+//       lexes and parses the file on the calling thread.  Returns false
+//       if the file cannot be opened; otherwise ast_root is the tree,
+//       or NULL, and errors the number of syntax errors.  If a lexical
+//       error or too many syntax errors end the compilation (see
+//       abort_compilation in utilities.h) inside a batch, the thread's
+//       scanner and parser state is released before CompilationAborted
+//       is passed on.
+//
+//  The tree stays valid for as long as the context does.  Passes over
+//  it may still allocate (flattening a list does), so a thread that
+//  checks or dumps the tree while others are at work should point its
+//  ast_arena at the context's arena while it does.  The symbols
+//  in it are interned in the global string tables, so while several
+//  threads parse at once the tables must be shared: call begin_shared()
+//  on idtable, inttable, stringtable and floattable before starting
+//  them, and end_shared() once they have all finished.
+//
+//  Diagnostics are written to diagnostics() (see utilities.h) as they
+//  are found: cerr, unless a batch driver has given the thread a
+//  stream of its own.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "arena.h"
+#include "seal-tree.handcode.h"
+
+class ParseContext {
+private:
+  ParseContext(const ParseContext &);             // not copyable
+  ParseContext &operator =(const ParseContext &);
+
+  void finish(Arena *saved_arena);
+
+public:
+  char *filename;
+  bool mapped;
+  Arena arena;          // the nodes of the tree
+  Program ast_root;     // the tree, or NULL
+  int errors;           // syntax errors
+
+  ParseContext(char *f, bool m)
+    : filename(f), mapped(m), arena(1 << 20), ast_root(NULL), errors(0) { }
+
+  bool parse();
+};
+
+#endif
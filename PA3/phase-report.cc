@@ -0,0 +1,214 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  phase-report.cc
+//
+//  Measuring the phases of a compilation (see phase-report.h).  Each
+//  thread keeps its own figures; merge_phase_report adds them to the
+//  totals under a lock.  operator new is replaced here so that heap
+//  allocations are counted along with arena ones.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <mutex>
+#include <new>
+#include "phase-report.h"
+#include "stringtab.h"
+
+struct PhaseStats {
+  double wall, cpu;     // seconds
+  long allocs, alloc_bytes;
+  long peak_rss;        // KB
+};
+
+static thread_local PhaseStats thread_stats[PHASES];
+static thread_local PhaseStats lex_in_timer;   // lexing inside the current timer
+
+static std::mutex totals_lock;
+static PhaseStats totals[PHASES];
+static PhaseCounts total_counts;
+
+static const char *phase_names[PHASES] = { "lex", "parse", "semant", "dump" };
+
+void *operator new(size_t size)
+{
+  phase_counts.allocs++;
+  phase_counts.alloc_bytes += size;
+  void *p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+static double now(clockid_t clock)
+{
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static long peak_rss()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+PhaseTimer::PhaseTimer(Phase p) : phase(p), active(phase_report != REPORT_NONE)
+{
+  if (!active)
+    return;
+  wall = now(CLOCK_MONOTONIC);
+  cpu = now(CLOCK_THREAD_CPUTIME_ID);
+  allocs = phase_counts.allocs;
+  alloc_bytes = phase_counts.alloc_bytes;
+  lex_in_timer = PhaseStats();
+}
+
+PhaseTimer::~PhaseTimer()
+{
+  if (!active)
+    return;
+  PhaseStats spent;
+  spent.wall = now(CLOCK_MONOTONIC) - wall;
+  spent.cpu = now(CLOCK_THREAD_CPUTIME_ID) - cpu;
+  spent.allocs = phase_counts.allocs - allocs;
+  spent.alloc_bytes = phase_counts.alloc_bytes - alloc_bytes;
+  spent.peak_rss = peak_rss();
+
+  PhaseStats &lex = lex_in_timer;
+  if (spent.wall > 0)
+    lex.cpu = spent.cpu * (lex.wall / spent.wall);
+  lex.peak_rss = spent.peak_rss;
+  spent.wall -= lex.wall;
+  spent.cpu -= lex.cpu;
+  spent.allocs -= lex.allocs;
+  spent.alloc_bytes -= lex.alloc_bytes;
+
+  PhaseStats *phases[2] = { &thread_stats[phase], &thread_stats[PHASE_LEX] };
+  PhaseStats *parts[2] = { &spent, &lex };
+  for (int i = 0; i < 2; i++) {
+    phases[i]->wall += parts[i]->wall;
+    phases[i]->cpu += parts[i]->cpu;
+    phases[i]->allocs += parts[i]->allocs;
+    phases[i]->alloc_bytes += parts[i]->alloc_bytes;
+    if (parts[i]->wall > 0 && parts[i]->peak_rss > phases[i]->peak_rss)
+      phases[i]->peak_rss = parts[i]->peak_rss;
+  }
+  lex_in_timer = PhaseStats();
+}
+
+extern int seal_yylex(void);
+
+int lex_token()
+{
+  phase_counts.tokens++;
+  if (phase_report == REPORT_NONE)
+    return seal_yylex();
+  double start = now(CLOCK_MONOTONIC);
+  long allocs = phase_counts.allocs;
+  long alloc_bytes = phase_counts.alloc_bytes;
+  int token = seal_yylex();
+  lex_in_timer.wall += now(CLOCK_MONOTONIC) - start;
+  lex_in_timer.allocs += phase_counts.allocs - allocs;
+  lex_in_timer.alloc_bytes += phase_counts.alloc_bytes - alloc_bytes;
+  return token;
+}
+
+void merge_phase_report()
+{
+  std::lock_guard<std::mutex> hold(totals_lock);
+  for (int p = 0; p < PHASES; p++) {
+    totals[p].wall += thread_stats[p].wall;
+    totals[p].cpu += thread_stats[p].cpu;
+    totals[p].allocs += thread_stats[p].allocs;
+    totals[p].alloc_bytes += thread_stats[p].alloc_bytes;
+    if (thread_stats[p].peak_rss > totals[p].peak_rss)
+      totals[p].peak_rss = thread_stats[p].peak_rss;
+    thread_stats[p] = PhaseStats();
+  }
+  total_counts.tokens += phase_counts.tokens;
+  total_counts.nodes += phase_counts.nodes;
+  total_counts.lookups += phase_counts.lookups;
+  total_counts.allocs += phase_counts.allocs;
+  total_counts.alloc_bytes += phase_counts.alloc_bytes;
+  phase_counts = PhaseCounts();
+}
+
+// The symbols in the string tables, which must not be shared.
+static long symbols_interned()
+{
+  return (long) idtable.size() + inttable.size() + stringtable.size() +
+         floattable.size();
+}
+
+static void print_text(ostream &s)
+{
+  char line[160];
+  s << "phase        wall ms     cpu ms       allocs        bytes  peak rss KB\n";
+  for (int p = 0; p < PHASES; p++) {
+    snprintf(line, sizeof line, "%-8s %10.3f %10.3f %12ld %12ld %12ld\n",
+             phase_names[p], totals[p].wall * 1e3, totals[p].cpu * 1e3,
+             totals[p].allocs, totals[p].alloc_bytes, totals[p].peak_rss);
+    s << line;
+  }
+  s << "tokens " << total_counts.tokens
+    << ", AST nodes " << total_counts.nodes
+    << ", symbols " << symbols_interned()
+    << ", symbol table lookups " << total_counts.lookups << "\n";
+}
+
+static void print_json(ostream &s)
+{
+  char number[64];
+  s << "{\"phases\": {";
+  for (int p = 0; p < PHASES; p++) {
+    s << (p ? ", " : "") << "\"" << phase_names[p] << "\": {";
+    snprintf(number, sizeof number, "%.3f", totals[p].wall * 1e3);
+    s << "\"wall_ms\": " << number;
+    snprintf(number, sizeof number, "%.3f", totals[p].cpu * 1e3);
+    s << ", \"cpu_ms\": " << number
+      << ", \"allocs\": " << totals[p].allocs
+      << ", \"alloc_bytes\": " << totals[p].alloc_bytes
+      << ", \"peak_rss_kb\": " << totals[p].peak_rss << "}";
+  }
+  s << "}, \"counts\": {"
+    << "\"tokens\": " << total_counts.tokens
+    << ", \"ast_nodes\": " << total_counts.nodes
+    << ", \"symbols\": " << symbols_interned()
+    << ", \"symbol_lookups\": " << total_counts.lookups
+    << ", \"allocs\": " << total_counts.allocs
+    << ", \"alloc_bytes\": " << total_counts.alloc_bytes << "}}\n";
+}
+
+void print_phase_report(ostream &s, bool json)
+{
+  if (json)
+    print_json(s);
+  else
+    print_text(s);
+  s.flush();
+}
@@ -0,0 +1,98 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef PHASE_REPORT_H
+#define PHASE_REPORT_H
+//////////////////////////////////////////////////////////////////////
+//
+//  phase-report.h
+//
+//  Where a compilation spends its time and memory.  With -R text or
+//  -R json, semant reports on stderr, for each phase (lexing, parsing,
+//  semantic analysis and writing the dump), the wall and CPU time it
+//  took, the objects it allocated and their bytes, and the peak RSS of
+//  the process when it ended; and, for the whole run, the number of
+//  tokens, AST nodes, symbols interned and symbol table lookups.
+//
+//     PhaseTimer t(PHASE_SEMANT)
+//       charges what happens on this thread until t goes out of scope
+//       to the phase.  Does nothing unless phase_report is set.
+//
+//     int lex_token()
+//       seal_yylex for the parser.  Under -R each call is charged to
+//       PHASE_LEX rather than to the parse around it.
+//
+//     void merge_phase_report()
+//       adds what this thread has measured to the run's totals.  Each
+//       thread that compiled something calls it once it has finished.
+//
+//     void print_phase_report(ostream &s, bool json)
+//       prints the totals, as a table or as one JSON object.
+//
+//  Lexing runs inside parsing, a token at a time, and reading the
+//  thread CPU clock costs about as much as lexing a token, so only the
+//  wall time of each token is measured.  The CPU time of a parse is
+//  split between the two phases in proportion to their wall time.
+//
+//  Allocations are those made through operator new and from arenas
+//  (arena.h), which their callers count with count_alloc; the arenas'
+//  own chunks are not counted again.  Lookups
+//  are those of the semantic checker's HashedSymbolTable (symtab.h).
+//  In a batch each thread's figures are added together, so the times
+//  are the sum over all threads rather than elapsed time.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "seal-io.h"
+
+enum Phase { PHASE_LEX, PHASE_PARSE, PHASE_SEMANT, PHASE_DUMP, PHASES };
+
+enum ReportFormat { REPORT_NONE, REPORT_TEXT, REPORT_JSON };
+
+extern int phase_report;        // -R: a ReportFormat
+
+//
+// Counted all the time, by the code that does the work; cheap enough
+// not to need a check of phase_report.
+//
+struct PhaseCounts {
+  long tokens;
+  long nodes;        // AST nodes built
+  long lookups;      // symbol table lookups and probes
+  long allocs;       // objects allocated
+  long alloc_bytes;  // and their size
+};
+
+extern thread_local PhaseCounts phase_counts;
+
+// Counts an allocation of n bytes that operator new does not see: the
+// code that allocates from an arena (arena.h) calls it.
+inline void count_alloc(size_t n)
+{
+  phase_counts.allocs++;
+  phase_counts.alloc_bytes += n;
+}
+
+class PhaseTimer {
+private:
+  Phase phase;
+  bool active;
+  double wall, cpu;             // when the timer started
+  long allocs, alloc_bytes;
+
+  PhaseTimer(const PhaseTimer &);             // not copyable
+  PhaseTimer &operator =(const PhaseTimer &);
+
+public:
+  PhaseTimer(Phase p);
+  ~PhaseTimer();
+};
+
+int lex_token();
+void merge_phase_report();
+void print_phase_report(ostream &s, bool json);
+
+#endif
@@ -0,0 +1,62 @@
+#!/bin/bash
+#
+# run_test.sh: runs Seal programs on every backend and checks that
+# they print the same thing.
+#
+#   vm    semant -x, the bytecode VM
+#   x86   semant -S, built with gcc and seal-runtime.c
+#   c     semant -C, built with gcc -O2 and seal-runtime.c
+#
+# Each program in test-run is run on each backend and its output
+# compared with test-run-answer.  Then every program in test-run and
+# test that passes the checker is run on the three backends, and the
+# outputs are compared with each other.
+
+cd "$(dirname "$0")"
+
+# Run $2 on backend $1, writing what it prints to $3.
+run() {
+    rm -f "$3"
+    case $1 in
+    vm)
+        ../semant -x "$2" > "$3" 2>&1 ;;
+    x86)
+        ../semant -S "$2" -o temp.s &&
+            gcc temp.s ../seal-runtime.c -lm -o temp.out &&
+            ./temp.out > "$3" 2>&1 ;;
+    c)
+        ../semant -C "$2" -o temp.c &&
+            gcc -O2 -I.. temp.c ../seal-runtime.c -lm -o temp.out &&
+            ./temp.out > "$3" 2>&1 ;;
+    esac
+}
+
+result() {
+    if [ $? -eq 0 ]; then
+        echo "Passed"
+    else
+        echo NOT passed
+    fi
+}
+
+cd test-run
+for filename in *.seal; do
+    for backend in vm x86 c; do
+        echo "--------Running" $filename "on" $backend"--------"
+        run $backend $filename tempfile
+        diff tempfile ../test-run-answer/$filename.out > /dev/null 2>&1
+        result
+    done
+done
+
+for filename in *.seal ../test/*.seal; do
+    ../semant $filename > /dev/null 2>&1 || continue
+    echo "--------Comparing the backends on" $filename"--------"
+    run vm $filename temp-vm
+    run x86 $filename temp-x86
+    run c $filename temp-c
+    diff temp-vm temp-x86 > /dev/null 2>&1 && diff temp-vm temp-c > /dev/null 2>&1
+    result
+done
+rm -f tempfile temp-vm temp-x86 temp-c temp.s temp.c temp.out
+cd ..
@@ -11,9 +11,9 @@ Decl VariableDecl_class::copy_Decl()
 }
 
 
-void VariableDecl_class::dump(ostream& stream, int n)
+void VariableDecl_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_variableDecl\n";
+   stream << indent(n) << "_variableDecl\n";
    variable->dump(stream, n+2);
 }
 
@@ -24,9 +24,9 @@ Variable Variable_class::copy_Variable()
 }
 
 
-void Variable_class::dump(ostream& stream, int n)
+void Variable_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_variable\n";
+   stream << indent(n) << "_variable\n";
    dump_Symbol(stream, n+2, name);
    dump_Symbol(stream, n+2, type);
 }
@@ -38,9 +38,9 @@ Decl CallDecl_class::copy_Decl()
 }
 
 
-void CallDecl_class::dump(ostream& stream, int n)
+void CallDecl_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_callDecl\n";
+   stream << indent(n) << "_callDecl\n";
    dump_Symbol(stream, n+2, name);
    paras->dump(stream, n+2);
    body->dump(stream, n+2);
@@ -11,12 +11,13 @@ class Decl_class : public tree_node {
 public:
     tree_node *copy()		 { return copy_Decl(); }
     virtual Decl copy_Decl() = 0;
-    virtual void dump_with_types(ostream&,int) = 0; 
-    virtual void dump(ostream&,int) = 0;
+    virtual void dump_with_types(DumpWriter&,int) = 0; 
+    virtual void dump(DumpWriter&,int) = 0;
     virtual bool isCallDecl() = 0;
     virtual Symbol getName() = 0;
     virtual Symbol getType() = 0;
     virtual void check() = 0;
+    virtual NodeId lower(CompactAst &) = 0;
 };
 
 
@@ -34,8 +35,9 @@ public:
    Symbol getType() { return type; }
 
    Variable copy_Variable();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int);
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int);
+   NodeId lower(CompactAst &);
 };
 
 class VariableDecl_class : public Decl_class {
@@ -50,8 +52,9 @@ public:
 
    Decl copy_Decl();
    void check();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int);
+   NodeId lower(CompactAst &);
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int);
    bool isCallDecl(){return false;};
 };
 
@@ -77,8 +80,9 @@ public:
 
    Decl copy_Decl();
    void check();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int);  
+   NodeId lower(CompactAst &);
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int);  
    bool isCallDecl(){return true;}
 };
 
@@ -10,9 +10,9 @@ Expr Assign_class::copy_Expr()
 }
 
 
-void Assign_class::dump(ostream& stream, int n)
+void Assign_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_assign\n";
+   stream << indent(n) << "_assign\n";
    dump_Symbol(stream, n+2, lvalue);
    value->dump(stream, n+2);
 }
@@ -23,9 +23,9 @@ Expr Add_class::copy_Expr()
 }
 
 
-void Add_class::dump(ostream& stream, int n)
+void Add_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_add\n";
+   stream << indent(n) << "_add\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -36,9 +36,9 @@ Expr Minus_class::copy_Expr()
 }
 
 
-void Minus_class::dump(ostream& stream, int n)
+void Minus_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_minus\n";
+   stream << indent(n) << "_minus\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -49,9 +49,9 @@ Expr Multi_class::copy_Expr()
 }
 
 
-void Multi_class::dump(ostream& stream, int n)
+void Multi_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_multi\n";
+   stream << indent(n) << "_multi\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -62,9 +62,9 @@ Expr Divide_class::copy_Expr()
 }
 
 
-void Divide_class::dump(ostream& stream, int n)
+void Divide_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_divide\n";
+   stream << indent(n) << "_divide\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -75,9 +75,9 @@ Expr Mod_class::copy_Expr()
 }
 
 
-void Mod_class::dump(ostream& stream, int n)
+void Mod_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_mod\n";
+   stream << indent(n) << "_mod\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -89,9 +89,9 @@ Expr Neg_class::copy_Expr()
 }
 
 
-void Neg_class::dump(ostream& stream, int n)
+void Neg_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_neg\n";
+   stream << indent(n) << "_neg\n";
    e1->dump(stream, n+2);
 }
 
@@ -101,9 +101,9 @@ Expr Lt_class::copy_Expr()
 }
 
 
-void Lt_class::dump(ostream& stream, int n)
+void Lt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_lt\n";
+   stream << indent(n) << "_lt\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -114,9 +114,9 @@ Expr Le_class::copy_Expr()
 }
 
 
-void Le_class::dump(ostream& stream, int n)
+void Le_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_le\n";
+   stream << indent(n) << "_le\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -127,9 +127,9 @@ Expr Equ_class::copy_Expr()
 }
 
 
-void Equ_class::dump(ostream& stream, int n)
+void Equ_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_equ\n";
+   stream << indent(n) << "_equ\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -140,9 +140,9 @@ Expr Neq_class::copy_Expr()
 }
 
 
-void Neq_class::dump(ostream& stream, int n)
+void Neq_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_neq\n";
+   stream << indent(n) << "_neq\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -153,9 +153,9 @@ Expr Ge_class::copy_Expr()
 }
 
 
-void Ge_class::dump(ostream& stream, int n)
+void Ge_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_ge\n";
+   stream << indent(n) << "_ge\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -166,9 +166,9 @@ Expr Gt_class::copy_Expr()
 }
 
 
-void Gt_class::dump(ostream& stream, int n)
+void Gt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_gt\n";
+   stream << indent(n) << "_gt\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -179,9 +179,9 @@ Expr And_class::copy_Expr()
 }
 
 
-void And_class::dump(ostream& stream, int n)
+void And_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_and\n";
+   stream << indent(n) << "_and\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -193,9 +193,9 @@ Expr Or_class::copy_Expr()
 }
 
 
-void Or_class::dump(ostream& stream, int n)
+void Or_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_or\n";
+   stream << indent(n) << "_or\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -207,9 +207,9 @@ Expr Xor_class::copy_Expr()
 }
 
 
-void Xor_class::dump(ostream& stream, int n)
+void Xor_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_xor\n";
+   stream << indent(n) << "_xor\n";
    e1->dump(stream, n+2);
    e2->dump(stream, n+2);
 }
@@ -221,9 +221,9 @@ Expr Not_class::copy_Expr()
 }
 
 
-void Not_class::dump(ostream& stream, int n)
+void Not_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_not\n";
+   stream << indent(n) << "_not\n";
    e1->dump(stream, n+2);
 }
 
@@ -234,9 +234,9 @@ Expr Bitnot_class::copy_Expr()
 }
 
 
-void Bitnot_class::dump(ostream& stream, int n)
+void Bitnot_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_bitnot\n";
+   stream << indent(n) << "_bitnot\n";
    e1->dump(stream, n+2);
 }
 
@@ -246,9 +246,9 @@ Expr Bitand_class::copy_Expr()
 }
 
 
-void Bitand_class::dump(ostream& stream, int n)
+void Bitand_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_bitand\n";
+   stream << indent(n) << "_bitand\n";
    e1->dump(stream, n+2);
 }
 
@@ -258,9 +258,9 @@ Expr Bitor_class::copy_Expr()
 }
 
 
-void Bitor_class::dump(ostream& stream, int n)
+void Bitor_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_bitor\n";
+   stream << indent(n) << "_bitor\n";
    e1->dump(stream, n+2);
 }
 
@@ -270,9 +270,9 @@ Object Object_class::copy_Object()
    return new Object_class(copy_Symbol(var));
 }
 
-void Object_class::dump(ostream& stream, int n)
+void Object_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_object\n";
+   stream << indent(n) << "_object\n";
    dump_Symbol(stream, n+2, var);
 }
 
@@ -282,9 +282,9 @@ Expr Call_class::copy_Expr()
    return new Call_class(copy_Symbol(name), actuals->copy_list());
 }
 
-void Call_class::dump(ostream& stream, int n)
+void Call_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_call\n";
+   stream << indent(n) << "_call\n";
    dump_Symbol(stream, n+2, name);
    actuals->dump(stream, n+2);
 }
@@ -294,9 +294,9 @@ Expr Actual_class::copy_Expr()
    return new Actual_class(expr->copy_Expr());
 }
 
-void Actual_class::dump(ostream& stream, int n)
+void Actual_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_actual\n";
+   stream << indent(n) << "_actual\n";
    expr->dump(stream, n+2);
 }
 
@@ -306,9 +306,9 @@ Expr Const_int_class::copy_Expr()
    return new Const_int_class(copy_Symbol(value));
 }
 
-void Const_int_class::dump(ostream& stream, int n)
+void Const_int_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_const_int\n";
+   stream << indent(n) << "_const_int\n";
    dump_Symbol(stream, n+2, value);
 }
 
@@ -317,9 +317,9 @@ Expr Const_string_class::copy_Expr()
    return new Const_string_class(copy_Symbol(value));
 }
 
-void Const_string_class::dump(ostream& stream, int n)
+void Const_string_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_const_string\n";
+   stream << indent(n) << "_const_string\n";
    dump_Symbol(stream, n+2, value);
 }
 
@@ -329,9 +329,9 @@ Expr Const_float_class::copy_Expr()
    return new Const_float_class(copy_Symbol(value));
 }
 
-void Const_float_class::dump(ostream& stream, int n)
+void Const_float_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_const_float\n";
+   stream << indent(n) << "_const_float\n";
    dump_Symbol(stream, n+2, value);
 }
 
@@ -341,9 +341,9 @@ Expr Const_bool_class::copy_Expr()
    return new Const_bool_class(copy_Boolean(value));
 }
 
-void Const_bool_class::dump(ostream& stream, int n)
+void Const_bool_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_const_bool\n";
+   stream << indent(n) << "_const_bool\n";
    dump_Boolean(stream, n+2, value);
 }
 
@@ -353,9 +353,9 @@ Expr No_expr_class::copy_Expr()
 }
 
 
-void No_expr_class::dump(ostream& stream, int n)
+void No_expr_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_no_expr\n";
+   stream << indent(n) << "_no_expr\n";
 }
 
 
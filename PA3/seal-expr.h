@@ -15,33 +15,57 @@ typedef class Call_class *Call;
 
 class Expr_class : public Stmt_class {
 public:     
+   unsigned char type_id;            // the TypeId of type, kept with it
    Symbol type;                      
    Symbol getType() { return type; }           
-   Expr setType(Symbol s) { type = s; return this; } 
+   TypeId getTypeId() { return (TypeId) type_id; }
+   Expr setType(Symbol s) {
+        type = s;
+        type_id = s ? s->get_type_id() : TY_NONE;
+        return this;
+   }
    Stmt copy_Stmt() { return copy_Expr(); }             
-   Expr_class() { type = (Symbol) NULL; }
+   Expr_class() { setType((Symbol) NULL); }
    Expr_class(Symbol a1) {
-        type = a1;
+        setType(a1);
    }
    bool isReturnStmt(){return false;}
    bool isBreakStmt(){return false;}
    bool isContinueStmt(){return false;}
-   void check(Symbol a) {checkType();}
-   void dump_type(ostream&, int);
+   void dump_type(DumpWriter&, int);
 
-   virtual void dump_with_types(ostream&,int) = 0; 
-	virtual void dump(ostream&,int) = 0;
+   virtual void dump_with_types(DumpWriter&,int) = 0; 
+	virtual void dump(DumpWriter&,int) = 0;
    virtual Expr copy_Expr() = 0;
-   virtual Symbol checkType() = 0;  // virtual function, realized by sub class
+   Symbol checkType();  // dispatches on kind, see semant.cc
    virtual bool is_empty_Expr() = 0;
 };
 
+// operators with two operands
+class BinaryOp_class : public Expr_class {
+protected:
+   Expr e1;
+   Expr e2;
+public:
+   Expr gete1(){return e1;}
+   Expr gete2(){return e2;}
+};
+
+// operators with one operand
+class UnaryOp_class : public Expr_class {
+protected:
+   Expr e1;
+public:
+   Expr gete1(){return e1;}
+};
+
 class Call_class : public Expr_class {
 protected:
    Symbol name;
    Actuals actuals;
 public:
    Call_class(Symbol a1, Actuals a2)  {
+        kind = K_CALL;
         name = a1;
         actuals = a2;
    }
@@ -49,10 +73,10 @@ public:
    Actuals getActuals(){return actuals;}
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump_with_types(ostream&,int); 
-	void dump(ostream&,int);
-   void dump_type(ostream& , int );
-   Symbol checkType();
+   void dump_with_types(DumpWriter&,int); 
+	void dump(DumpWriter&,int);
+   void dump_type(DumpWriter& , int );
+   NodeId lower(CompactAst &);
 };
 
 
@@ -61,14 +85,15 @@ protected:
     Expr expr;
 public:
    Actual_class(Expr a1)  {
+        kind = K_ACTUAL;
         expr = a1;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump_with_types(ostream&,int); 
-	void dump(ostream&,int);
-   void dump_type(ostream& , int );
-   Symbol checkType();
+   void dump_with_types(DumpWriter&,int); 
+	void dump(DumpWriter&,int);
+   void dump_type(DumpWriter& , int );
+   NodeId lower(CompactAst &);
    Expr getExpr(){return expr;}
 };
 
@@ -79,366 +104,297 @@ protected:
    Expr value;
 public:
    Assign_class(Symbol a1, Expr a2)  {
+      kind = K_ASSIGN;
       lvalue = a1;
       value = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
    Symbol getlValue(){return lvalue;}
    Expr getValue(){return value;}
 };
 
 // define constructor - add
-class Add_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Add_class : public BinaryOp_class {
 public:
    Add_class(Expr a1, Expr a2) {
+      kind = K_ADD;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - minus
-class Minus_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Minus_class : public BinaryOp_class {
 public:
    Minus_class(Expr a1, Expr a2) {
+      kind = K_MINUS;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - multi
-class Multi_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Multi_class : public BinaryOp_class {
 public:
    Multi_class(Expr a1, Expr a2) {
+      kind = K_MULTI;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int);
-   Symbol checkType(); 
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int);
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - divide
-class Divide_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Divide_class : public BinaryOp_class {
 public:
    Divide_class(Expr a1, Expr a2) {
+      kind = K_DIVIDE;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - mod
-class Mod_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Mod_class : public BinaryOp_class {
 public:
    Mod_class(Expr a1, Expr a2) {
+      kind = K_MOD;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - -
-class Neg_class : public Expr_class {
-protected:
-   Expr e1;
+class Neg_class : public UnaryOp_class {
 public:
    Neg_class(Expr a1) {
+      kind = K_NEG;
       e1 = a1;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - <
-class Lt_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Lt_class : public BinaryOp_class {
 public:
    Lt_class(Expr a1, Expr a2) {
+      kind = K_LT;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - <=
-class Le_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Le_class : public BinaryOp_class {
 public:
    Le_class(Expr a1, Expr a2) {
+      kind = K_LE;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - ==
-class Equ_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Equ_class : public BinaryOp_class {
 public:
    Equ_class(Expr a1, Expr a2) {
+      kind = K_EQU;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - !=
-class Neq_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Neq_class : public BinaryOp_class {
 public:
    Neq_class(Expr a1, Expr a2) {
+      kind = K_NEQ;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - >=
-class Ge_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Ge_class : public BinaryOp_class {
 public:
    Ge_class(Expr a1, Expr a2) {
+      kind = K_GE;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - >
-class Gt_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Gt_class : public BinaryOp_class {
 public:
    Gt_class(Expr a1, Expr a2) {
+      kind = K_GT;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - and &&
-class And_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class And_class : public BinaryOp_class {
 public:
    And_class(Expr a1, Expr a2) {
+      kind = K_AND;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - or ||
-class Or_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Or_class : public BinaryOp_class {
 public:
    Or_class(Expr a1, Expr a2) {
+      kind = K_OR;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - xor ^
-class Xor_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Xor_class : public BinaryOp_class {
 public:
    Xor_class(Expr a1, Expr a2) {
+      kind = K_XOR;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - not !
-class Not_class : public Expr_class {
-protected:
-   Expr e1;
+class Not_class : public UnaryOp_class {
 public:
    Not_class(Expr a1) {
+      kind = K_NOT;
       e1 = a1;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - bitnot ~
-class Bitnot_class : public Expr_class {
-protected:
-   Expr e1;
+class Bitnot_class : public UnaryOp_class {
 public:
    Bitnot_class(Expr a1) {
+      kind = K_BITNOT;
       e1 = a1;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
-class Bitand_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Bitand_class : public BinaryOp_class {
 public:
    Bitand_class(Expr a1, Expr a2) {
+      kind = K_BITAND;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
-class Bitor_class : public Expr_class {
-protected:
-   Expr e1;
-   Expr e2;
+class Bitor_class : public BinaryOp_class {
 public:
    Bitor_class(Expr a1, Expr a2) {
+      kind = K_BITOR;
       e1 = a1;
       e2 = a2;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
-   Expr gete1(){return e1;}
-   Expr gete2(){return e2;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructconst_int - const_int
@@ -447,13 +403,15 @@ protected:
    Symbol value;
 public:
    Const_int_class(Symbol a1) {
+      kind = K_CONST_INT;
       value = a1;
    }
+   Symbol getValue(){return value;}
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructconst_string - const_string
@@ -462,13 +420,15 @@ protected:
    Symbol value;
 public:
    Const_string_class(Symbol a1) {
+      kind = K_CONST_STRING;
       value = a1;
    }
+   Symbol getValue(){return value;}
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructconst_float - const_float
@@ -477,13 +437,15 @@ protected:
    Symbol value;
 public:
    Const_float_class(Symbol a1) {
+      kind = K_CONST_FLOAT;
       value = a1;
    }
+   Symbol getValue(){return value;}
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructconst_bool - const_bool
@@ -492,13 +454,15 @@ protected:
    Boolean value;
 public:
    Const_bool_class(Boolean a1) {
+      kind = K_CONST_BOOL;
       value = a1;
    }
+   Boolean getValue(){return value;}
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 class Object_class : public Expr_class {
@@ -506,14 +470,16 @@ protected:
    Symbol var;
 public:
    Object_class(Symbol a1) {
+      kind = K_OBJECT;
       var = a1;
    }
    bool is_empty_Expr(){ return false;}
    Expr copy_Expr(){return copy_Object();};
    Object copy_Object();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   Symbol getVar(){return var;}
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 // define constructor - no_expr
@@ -521,12 +487,13 @@ class No_expr_class : public Expr_class {
 protected:
 public:
    No_expr_class() {
+   kind = K_NO_EXPR;
    }
    bool is_empty_Expr(){ return true;}
    Expr copy_Expr();
-   void dump(ostream& stream, int n);
-   void dump_with_types(ostream&,int); 
-   Symbol checkType();
+   void dump(DumpWriter& stream, int n);
+   void dump_with_types(DumpWriter&,int); 
+   NodeId lower(CompactAst &);
 };
 
 
@@ -203,12 +203,12 @@ typedef size_t yy_size_t;
 #endif
 
 /* %if-not-reentrant */
-extern yy_size_t yyleng;
+extern thread_local yy_size_t yyleng;
 /* %endif */
 
 /* %if-c-only */
 /* %if-not-reentrant */
-extern FILE *yyin, *yyout;
+extern thread_local FILE *yyin, *yyout;
 /* %endif */
 /* %endif */
 
@@ -310,9 +310,9 @@ struct yy_buffer_state
 /* %if-not-reentrant */
 
 /* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
+static thread_local size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
+static thread_local size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
+static thread_local YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
 /* %endif */
 /* %ok-for-header */
 
@@ -339,19 +339,19 @@ static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
 /* %not-for-header */
 
 /* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
-static yy_size_t yy_n_chars;		/* number of characters read into yy_ch_buf */
-yy_size_t yyleng;
+static thread_local char yy_hold_char;
+static thread_local yy_size_t yy_n_chars;		/* number of characters read into yy_ch_buf */
+thread_local yy_size_t yyleng;
 
 /* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
+static thread_local char *yy_c_buf_p = (char *) 0;
+static thread_local int yy_init = 0;		/* whether we need to initialize */
+static thread_local int yy_start = 0;	/* start state number */
 
 /* Flag which is used to allow yywrap()'s to do buffer switches
  * instead of setting up a fresh yyin.  A bit of a hack ...
  */
-static int yy_did_buffer_switch_on_eof;
+static thread_local int yy_did_buffer_switch_on_eof;
 /* %ok-for-header */
 
 /* %endif */
@@ -414,15 +414,15 @@ void yyfree (void *  );
 
 typedef unsigned char YY_CHAR;
 
-FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
+thread_local FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
 
 typedef int yy_state_type;
 
-extern int yylineno;
+extern thread_local int yylineno;
 
-int yylineno = 1;
+thread_local int yylineno = 1;
 
-extern char *yytext;
+extern thread_local char *yytext;
 #define yytext_ptr yytext
 
 /* %if-c-only Standard (non-C++) definition */
@@ -628,8 +628,8 @@ static yyconst flex_int16_t yy_chk[277] =
       145,  145,  145,  145,  145,  145
     } ;
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
+static thread_local yy_state_type yy_last_accepting_state;
+static thread_local char *yy_last_accepting_cpos;
 
 extern int yy_flex_debug;
 int yy_flex_debug = 1;
@@ -652,7 +652,7 @@ static yyconst flex_int16_t yy_rule_linenum[68] =
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *yytext;
+thread_local char *yytext;
 #line 1 "seal.flex"
 /*
 *  The scanner definition for seal.
@@ -678,7 +678,12 @@ char *yytext;
 #define MAX_STR_CONST 256
 #define YY_NO_UNPUT   /* keep g++ happy */
 
-extern FILE *fin; /* we read from this file */
+/*
+ * All of the scanner's state, flex's own and ours, is thread_local, so
+ * each thread can lex a file of its own at the same time (see
+ * parse-context.h).
+ */
+extern thread_local FILE *fin; /* we read from this file */
 
 /* define YY_INPUT so we read from the FILE fin:
  * This change makes it possible to use this scanner in
@@ -689,21 +694,21 @@ extern FILE *fin; /* we read from this file */
 	if ( (result = fread( (char*)buf, sizeof(char), max_size, fin)) < 0) \
 		YY_FATAL_ERROR( "read() in flex scanner failed");
 
-char string_buf[MAX_STR_CONST]; /* to assemble string constants */
-char *string_buf_ptr;
+thread_local char string_buf[MAX_STR_CONST]; /* to assemble string constants */
+thread_local char *string_buf_ptr;
 
-extern int curr_lineno;
+extern thread_local int curr_lineno;
 extern int verbose_flag;
 
-extern YYSTYPE seal_yylval;
+extern thread_local YYSTYPE seal_yylval;
 
 /*
  *  Add Your own definitions here
  */
 
-char string_const[MAX_STR_CONST + 10];
-int string_const_len;
-bool str_contain_null_char;
+thread_local char string_const[MAX_STR_CONST + 10];
+thread_local int string_const_len;
+thread_local bool str_contain_null_char;
 
 /*
 * Define names for regular expressions here.
@@ -1121,8 +1126,8 @@ YY_RULE_SETUP
 case YY_STATE_EOF(BLOCK_COMMENT):
 #line 85 "seal.flex"
 { 
-	cerr << curr_lineno << ": Comment meets an EOF.\n";
-  exit(-1);
+	diagnostics() << curr_lineno << ": Comment meets an EOF.\n";
+  abort_compilation(-1);
 }
 	YY_BREAK
 case 9:
@@ -1134,8 +1139,8 @@ case 10:
 YY_RULE_SETUP
 #line 90 "seal.flex"
 {
-	cerr << curr_lineno << ": Unmatched */.\n";
-  exit(-1);
+	diagnostics() << curr_lineno << ": Unmatched */.\n";
+  abort_compilation(-1);
 }
 	YY_BREAK
 /*
@@ -1353,8 +1358,8 @@ YY_RULE_SETUP
 case YY_STATE_EOF(QUOTE_STRING):
 #line 171 "seal.flex"
 {
-	cerr << curr_lineno << ": String constant meets an EOF.\n";
-  exit(-1);
+	diagnostics() << curr_lineno << ": String constant meets an EOF.\n";
+  abort_compilation(-1);
 }
 	YY_BREAK
 case 48:
@@ -1362,8 +1367,8 @@ YY_RULE_SETUP
 #line 176 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	
 	int r = 0;
@@ -1385,8 +1390,8 @@ YY_RULE_SETUP
 #line 196 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	
 	int r = 0;
@@ -1402,8 +1407,8 @@ YY_RULE_SETUP
 #line 210 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	switch(yytext[1]) {
 		case '\"': string_const[string_const_len++] = '\"'; break;
@@ -1424,8 +1429,8 @@ YY_RULE_SETUP
 #line 228 "seal.flex"
 { 
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	string_const[string_const_len++] = '\n'; 
 	curr_lineno++; 
@@ -1436,8 +1441,8 @@ case 52:
 YY_RULE_SETUP
 #line 236 "seal.flex"
 {
-	cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+	diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 }
 	YY_BREAK
 case 53:
@@ -1445,8 +1450,8 @@ YY_RULE_SETUP
 #line 241 "seal.flex"
 { 
 	if (string_const_len > 0 && str_contain_null_char) {
-		cerr << curr_lineno << ": String contains a '\0'.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String contains a '\0'.\n";
+    abort_compilation(-1);
 	}
 	seal_yylval.symbol = stringtable.add_string(string_const);
 	BEGIN 0; return (CONST_STRING);
@@ -1457,8 +1462,8 @@ YY_RULE_SETUP
 #line 250 "seal.flex"
 { 
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	string_const[string_const_len++] = yytext[0]; 
 }
@@ -1478,8 +1483,8 @@ YY_RULE_SETUP
 #line 264 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	curr_lineno++;
 	string_const[string_const_len++] = yytext[0]; 
@@ -1490,8 +1495,8 @@ YY_RULE_SETUP
 #line 273 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	string_const[string_const_len++] = yytext[0]; 
 }
@@ -1501,8 +1506,8 @@ YY_RULE_SETUP
 #line 281 "seal.flex"
 {
 	if (string_const_len >= MAX_STR_CONST) {
-		cerr << curr_lineno << ": String length is more than 256.\n";
-    exit(-1);
+		diagnostics() << curr_lineno << ": String length is more than 256.\n";
+    abort_compilation(-1);
 	} 
 	seal_yylval.symbol = stringtable.add_string(string_const);
 	BEGIN 0; return (CONST_STRING);
@@ -1511,8 +1516,8 @@ YY_RULE_SETUP
 case YY_STATE_EOF(REVERSE_STRING):
 #line 290 "seal.flex"
 {
-	cerr << curr_lineno << ": String constant meets an EOF.\n";
-    exit(-1);
+	diagnostics() << curr_lineno << ": String constant meets an EOF.\n";
+    abort_compilation(-1);
 }
 	YY_BREAK
 /*
@@ -1590,16 +1595,16 @@ case 65:
 YY_RULE_SETUP
 #line 349 "seal.flex"
 {
-	cerr << curr_lineno << ": Illegal Type name " << yytext << ".\n";
-    exit(-1);
+	diagnostics() << curr_lineno << ": Illegal Type name " << yytext << ".\n";
+    abort_compilation(-1);
 }
 	YY_BREAK
 case 66:
 YY_RULE_SETUP
 #line 354 "seal.flex"
 {
-	cerr << curr_lineno << ": Illegal Identifier name " << yytext << ".\n";
-    exit(-1);
+	diagnostics() << curr_lineno << ": Illegal Identifier name " << yytext << ".\n";
+    abort_compilation(-1);
 }
 	YY_BREAK
 /*
@@ -1609,8 +1614,8 @@ case 67:
 YY_RULE_SETUP
 #line 363 "seal.flex"
 {
-	cerr << curr_lineno << ": Illegal character " << yytext << ".\n";
-    exit(-1);
+	diagnostics() << curr_lineno << ": Illegal character " << yytext << ".\n";
+    abort_compilation(-1);
 }
 	YY_BREAK
 case 68:
@@ -2747,3 +2752,31 @@ void yyfree (void * ptr )
 
 
 
+
+
+void seal_lex_end();
+
+/*
+ * Start scanning a new input: the buffer base of size bytes, whose
+ * last two bytes must be null (see source-map.h), or fin if base is
+ * NULL.  The scanner reads a mapped buffer in place, without YY_INPUT.
+ */
+void seal_lex_begin(char *base, yy_size_t size)
+{
+	seal_lex_end();
+	if (base)
+		yy_scan_buffer(base, size);
+	else
+		yy_switch_to_buffer(yy_create_buffer(fin, YY_BUF_SIZE));
+	BEGIN 0;
+}
+
+/*
+ * Let go of the input, so that it can be closed or unmapped, and free
+ * this thread's buffer stack, which a batch or -P worker would
+ * otherwise leak when it exits.
+ */
+void seal_lex_end()
+{
+	yylex_destroy();
+}
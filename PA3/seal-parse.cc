@@ -79,14 +79,15 @@
   #include "seal-expr.h"
   #include "stringtab.h"
   #include "utilities.h"
+  #include "phase-report.h"
 
-  extern char *curr_filename;
+  extern thread_local char *curr_filename;
   /* Locations */
   #define YYLTYPE int              /* the type of locations */
   #define seal_yylloc curr_lineno  /* use the curr_lineno from the lexer
   for the location of tokens */
     
-    extern int node_lineno;          /* set before constructing a tree node
+    extern thread_local int node_lineno; /* set before constructing a tree node
     to whatever you want the line number
     for the tree node to be */
       
@@ -149,9 +150,9 @@
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
     
-    Program ast_root;	      /* the result of the parse  */
+    thread_local Program ast_root;  /* the result of the parse  */
     //Decls parse_results;        /* for use in semantic analysis */
-    int omerrs = 0;               /* number of errors in lexing and parsing */
+    thread_local int omerrs = 0;  /* number of errors in lexing and parsing */
     
 
 #line 158 "seal.tab.c" /* yacc.c:339  */
@@ -305,8 +306,8 @@ struct YYLTYPE
 #endif
 
 
-extern YYSTYPE seal_yylval;
-extern YYLTYPE seal_yylloc;
+extern thread_local YYSTYPE seal_yylval;
+extern thread_local YYLTYPE seal_yylloc;
 int seal_yyparse (void);
 
 #endif /* !YY_SEAL_YY_SEAL_TAB_H_INCLUDED  */
@@ -1416,18 +1417,18 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 
 
 /* The lookahead symbol.  */
-int yychar;
+thread_local int yychar;
 
 /* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
+thread_local YYSTYPE yylval;
 /* Location data for the lookahead symbol.  */
-YYLTYPE yylloc
+thread_local YYLTYPE yylloc
 # if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
   = { 1, 1, 1, 1 }
 # endif
 ;
 /* Number of syntax errors so far.  */
-int yynerrs;
+thread_local int yynerrs;
 
 
 /*----------.
@@ -1608,7 +1609,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = yylex ();
+      yychar = lex_token ();
     }
 
   if (yychar <= YYEOF)
@@ -2530,13 +2531,13 @@ yyreturn:
     /* This function is called automatically when Bison detects a parse error. */
     void yyerror(char *s)
     {
-      extern int curr_lineno;
+      extern thread_local int curr_lineno;
       
-      cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
+      diagnostics() << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
       << s << " at or near ";
       print_seal_token(yychar);
-      cerr << endl;
+      diagnostics() << endl;
       omerrs++;
       
-      if(omerrs>50) {fprintf(stdout, "More than 50 errors\n"); exit(1);}
+      if(omerrs>50) {diagnostics() << "More than 50 errors\n"; abort_compilation(1);}
     }
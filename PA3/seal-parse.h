@@ -193,7 +193,7 @@ typedef union YYSTYPE
 # define YYSTYPE_IS_TRIVIAL 1
 #endif
 
-extern YYSTYPE seal_yylval;
+extern thread_local YYSTYPE seal_yylval;
 
 #if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
 typedef struct YYLTYPE
@@ -208,5 +208,5 @@ typedef struct YYLTYPE
 # define YYLTYPE_IS_TRIVIAL 1
 #endif
 
-extern YYLTYPE seal_yylloc;
+extern thread_local YYLTYPE seal_yylloc;
 #endif
@@ -0,0 +1,77 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  seal-runtime.c
+//
+//  The C runtime linked into the native programs written by semant -S
+//  (see x86-cgen.h) and semant -C (see c-cgen.h):
+//
+//     gcc prog.s seal-runtime.c -lm -o prog
+//     gcc -O2 prog.c seal-runtime.c -lm -o prog
+//
+//  main calls the Seal main, whose code gives it the symbol seal_start.
+//  The generated code calls the functions below for what it does not
+//  do inline, and compares the stack pointer with seal_stack_limit
+//  before every call, so that runaway recursion is reported as in the
+//  VM instead of crashing.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "seal-runtime.h"
+
+// room left below the limit for the runtime and the C library
+#define STACK_MARGIN (256 << 10)
+
+char *seal_stack_limit;
+
+// printf: args[0] is the format, types has a letter per argument.
+void seal_printf(const char *types, const union Value *args)
+{
+  seal_print(stdout, args, types);
+}
+
+static void runtime_error(long line, const char *message)
+{
+  fflush(stdout);
+  fprintf(stderr, "%ld: runtime error: %s\n", line, message);
+  exit(1);
+}
+
+void seal_division_by_zero(long line)
+{
+  runtime_error(line, "division by zero");
+}
+
+void seal_stack_overflow(long line)
+{
+  runtime_error(line, "stack overflow");
+}
+
+double seal_fmod(double x, double y)
+{
+  return fmod(x, y);
+}
+
+int main(void)
+{
+  struct rlimit limit;
+  size_t size = 8 << 20;
+  char here;
+
+  if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+    size = limit.rlim_cur;
+  seal_stack_limit = size > 2 * STACK_MARGIN ? &here - size + STACK_MARGIN
+                                             : &here - size / 2;
+  seal_start();
+  fflush(stdout);
+  return 0;
+}
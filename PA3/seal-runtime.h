@@ -0,0 +1,144 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef SEAL_RUNTIME_H
+#define SEAL_RUNTIME_H
+//////////////////////////////////////////////////////////////////////
+//
+//  seal-runtime.h
+//
+//  What the bytecode VM (bytecode.h) and the C runtime of native
+//  programs (seal-runtime.c, see x86-cgen.h and c-cgen.h) share: the
+//  representation of a value and printf.  This header is C as well as
+//  C++, since the runtime is compiled by the system C compiler along
+//  with the generated assembly, and the generated C includes it.
+//
+//     union Value
+//       an Int, Bool (0 or 1), Float or String in 64 bits.
+//     void seal_print(FILE *out, const union Value *args,
+//                     const char *types)
+//       printf with the format args[0] and the arguments after it,
+//       whose types are given by types, one of 'i', 'f', 'b' or 's'
+//       per argument (the format included).  A NaN prints as nan
+//       whatever its sign bit, which depends on how it was computed.
+//
+//  and what seal-runtime.c gives the generated code:
+//
+//     seal_stack_limit            rsp must stay above it
+//     seal_start()                the Seal main, defined by the program
+//     seal_printf(types, args)    seal_print to stdout
+//     seal_division_by_zero(line), seal_stack_overflow(line)
+//                                 report a runtime error and exit 1
+//     seal_fmod(x, y)             fmod
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+union Value {
+  long i;
+  double f;
+  const char *s;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern char *seal_stack_limit;
+void seal_start(void);
+void seal_printf(const char *types, const union Value *args);
+void seal_division_by_zero(long line);
+void seal_stack_overflow(long line);
+double seal_fmod(double x, double y);
+#ifdef __cplusplus
+}
+#endif
+
+// f, with the sign of a NaN cleared.  That sign depends on the
+// instruction, or the constant folding, that made the NaN, so two
+// backends could print the same value as nan and -nan.
+static double seal_print_float(double f)
+{
+  return f != f ? fabs(f) : f;
+}
+
+// printf with the arguments args, whose types are given by types.  A
+// conversion takes the next argument whatever it is, converting Int
+// and Float into each other as needed; a Bool printed with %s is
+// "true" or "false".
+static void seal_print(FILE *out, const union Value *args, const char *types)
+{
+  const char *format = args[0].s ? args[0].s : "";
+  size_t next = 1, count = strlen(types);
+  char spec[64];
+  for (const char *p = format; *p; p++) {
+    if (*p != '%') {
+      putc(*p, out);
+      continue;
+    }
+    if (p[1] == '%') {
+      putc('%', out);
+      p++;
+      continue;
+    }
+    // Copy the flags, width and precision, dropping length modifiers.
+    size_t n = 0;
+    spec[n++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && n < sizeof spec - 4)
+      spec[n++] = *p++;
+    while (*p && strchr("hlLqjzt", *p))
+      p++;
+    if (!*p)
+      break;
+    char conversion = *p;
+    union Value v;
+    char type = 'i';
+    if (next < count) {
+      v = args[next];
+      type = types[next];
+      next++;
+    } else {
+      v.i = 0;
+    }
+    switch (conversion) {
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+      spec[n++] = 'l';
+      spec[n++] = conversion;
+      spec[n] = '\0';
+      fprintf(out, spec, type == 'f' ? (long) v.f : v.i);
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+      spec[n++] = conversion;
+      spec[n] = '\0';
+      fprintf(out, spec, type == 'f' ? seal_print_float(v.f) : (double) v.i);
+      break;
+    case 's':
+      spec[n++] = 's';
+      spec[n] = '\0';
+      if (type == 's')
+        fprintf(out, spec, v.s ? v.s : "");
+      else if (type == 'b')
+        fprintf(out, spec, v.i ? "true" : "false");
+      else {
+        char number[32];
+        if (type == 'f')
+          snprintf(number, sizeof number, "%f", seal_print_float(v.f));
+        else
+          snprintf(number, sizeof number, "%ld", v.i);
+        fprintf(out, spec, number);
+      }
+      break;
+    default:
+      fputs(spec, out);
+      putc(conversion, out);
+      break;
+    }
+  }
+}
+
+#endif
@@ -8,9 +8,9 @@ Program Program_class::copy_Program()
    return new Program_class(decls->copy_list());
 }
 
-void Program_class::dump(ostream& stream, int n)
+void Program_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_program\n";
+   stream << indent(n) << "_program\n";
    decls->dump(stream, n+2);
 }
 
@@ -19,9 +19,9 @@ StmtBlock StmtBlock_class::copy_StmtBlock()
    return new StmtBlock_class(vars->copy_list(), stmts->copy_list());
 }
 
-void StmtBlock_class::dump(ostream& stream, int n)
+void StmtBlock_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_stmtBlock\n";
+   stream << indent(n) << "_stmtBlock\n";
    vars->dump(stream, n+2);
    stmts->dump(stream, n+2);
 }
@@ -33,9 +33,9 @@ Stmt IfStmt_class::copy_Stmt()
 }
 
 
-void IfStmt_class::dump(ostream& stream, int n)
+void IfStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_ifStmt\n";
+   stream << indent(n) << "_ifStmt\n";
    condition->dump(stream, n+2);
    thenexpr->dump(stream, n+2);
    elseexpr->dump(stream, n+2);
@@ -48,9 +48,9 @@ Stmt WhileStmt_class::copy_Stmt()
 }
 
 
-void WhileStmt_class::dump(ostream& stream, int n)
+void WhileStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_whileStmt\n";
+   stream << indent(n) << "_whileStmt\n";
    condition->dump(stream, n+2);
    body->dump(stream, n+2);
 }
@@ -62,9 +62,9 @@ Stmt ForStmt_class::copy_Stmt()
 }
 
 
-void ForStmt_class::dump(ostream& stream, int n)
+void ForStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_forStmt\n";
+   stream << indent(n) << "_forStmt\n";
    initexpr->dump(stream, n+2);
    condition->dump(stream, n+2);
    loopact->dump(stream, n+2);
@@ -78,9 +78,9 @@ Stmt BreakStmt_class::copy_Stmt()
 }
 
 
-void BreakStmt_class::dump(ostream& stream, int n)
+void BreakStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_breakStmt\n";
+   stream << indent(n) << "_breakStmt\n";
 }
 
 
@@ -90,9 +90,9 @@ Stmt ContinueStmt_class::copy_Stmt()
 }
 
 
-void ContinueStmt_class::dump(ostream& stream, int n)
+void ContinueStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_continueStmt\n";
+   stream << indent(n) << "_continueStmt\n";
 }
 
 Stmt ReturnStmt_class::copy_Stmt()
@@ -101,9 +101,9 @@ Stmt ReturnStmt_class::copy_Stmt()
 }
 
 
-void ReturnStmt_class::dump(ostream& stream, int n)
+void ReturnStmt_class::dump(DumpWriter& stream, int n)
 {
-   stream << pad(n) << "_returnStmt\n";
+   stream << indent(n) << "_returnStmt\n";
    value->dump(stream, n+2);
 }
 
@@ -15,11 +15,14 @@ public:
     }
     Program copy_Program();
 	tree_node *copy()		 { return copy_Program(); }
-    void dump(ostream& stream, int n);
-    void dump_with_types(ostream&, int);
+    void dump(DumpWriter& stream, int n);
+    void dump_with_types(DumpWriter&, int);
 
 	void semant();
-	// for semantic analysis
+	// for semantic analysis; exits if the program has errors
+	int check_program();
+	// the same, but returns the number of errors
+	NodeId lower(CompactAst &);
 };
 
 
@@ -27,13 +30,15 @@ class Stmt_class : public tree_node {
 protected:
 	bool is_in_loop_flag=false;
 public:
+	unsigned char kind; // a NodeKind naming the subclass, set by its constructor
 	tree_node *copy()		 { return copy_Stmt(); }
 	bool getLoopFlag(){return is_in_loop_flag;}
 	void setFlag(bool flag){is_in_loop_flag=flag;}
 	virtual Stmt copy_Stmt() = 0;
-	virtual void dump_with_types(ostream&,int) = 0; 
-	virtual void dump(ostream&,int) = 0;
-	virtual void check(Symbol) = 0;
+	virtual void dump_with_types(DumpWriter&,int) = 0; 
+	virtual void dump(DumpWriter&,int) = 0;
+	void check(Symbol);   // dispatches on kind, see semant.cc
+	virtual NodeId lower(CompactAst &) = 0;
 	virtual bool isReturnStmt()=0;
 	virtual bool isBreakStmt()=0;
 	virtual bool isContinueStmt()=0;
@@ -45,6 +50,7 @@ protected:
 	 Stmts	stmts;
 public:
 	StmtBlock_class(VariableDecls a1, Stmts a2) {
+		kind = K_STMT_BLOCK;
 		vars = a1;
 	    stmts = a2;
 	}
@@ -55,8 +61,8 @@ public:
 	StmtBlock copy_StmtBlock();
 	bool isReturnStmt(){
 		bool flag=false;
-		for(int i=stmts->first();stmts->more(i);i=stmts->next(i)){
-			if(stmts->nth(i)->isReturnStmt()){
+		for(Stmt stmt : *stmts){
+			if(stmt->isReturnStmt()){
 				flag=true;
 				break;
 			}
@@ -65,12 +71,12 @@ public:
 	}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return false;}
-	void check(Symbol);
-	void dump(ostream& , int );
-	void dump_with_types(ostream&,int);
+	NodeId lower(CompactAst &);
+	void dump(DumpWriter& , int );
+	void dump_with_types(DumpWriter&,int);
 	void pass_single_stmt_flag(){
-		for(int i=stmts->first();stmts->more(i);i=stmts->next(i)){
-			stmts->nth(i)->setFlag(is_in_loop_flag);
+		for(Stmt stmt : *stmts){
+			stmt->setFlag(is_in_loop_flag);
 		}
 	}
 };
@@ -82,6 +88,7 @@ protected:
 	StmtBlock thenexpr, elseexpr;
 public:
     IfStmt_class(Expr a1, StmtBlock a2, StmtBlock a3) {
+		kind = K_IF;
 		condition = a1;
 		thenexpr = a2;
 		elseexpr = a3;
@@ -90,9 +97,9 @@ public:
 	StmtBlock getThen(){return thenexpr;}
 	StmtBlock getElse(){return elseexpr;}
     Stmt copy_Stmt();
-	void check(Symbol);
-	void dump(ostream& stream, int n);
-	void dump_with_types(ostream&,int);
+	NodeId lower(CompactAst &);
+	void dump(DumpWriter& stream, int n);
+	void dump_with_types(DumpWriter&,int);
 	bool isReturnStmt(){return false;}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return false;}
@@ -107,15 +114,16 @@ protected:
 	StmtBlock body;
 public:
     WhileStmt_class(Expr a1, StmtBlock a2) {
+		kind = K_WHILE;
 		condition = a1;
 		body = a2;
 	}
 	Expr getCondition(){return condition;}
 	StmtBlock getBody(){return body;}
     Stmt copy_Stmt();
-	void check(Symbol);
-	void dump(ostream& stream, int n);
-	void dump_with_types(ostream&,int);
+	NodeId lower(CompactAst &);
+	void dump(DumpWriter& stream, int n);
+	void dump_with_types(DumpWriter&,int);
 	bool isReturnStmt(){return false;}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return false;}
@@ -127,6 +135,7 @@ protected:
 	StmtBlock body;
 public:
 	ForStmt_class(Expr a1, Expr a2, Expr a3, StmtBlock a4) {
+		kind = K_FOR;
 		initexpr = a1;
 		condition = a2;
 		loopact = a3;
@@ -136,10 +145,10 @@ public:
 	Expr getCondition(){return condition;}
 	Expr getLoop(){return loopact;}
 	StmtBlock getBody(){return body;}
-	void check(Symbol);
+	NodeId lower(CompactAst &);
     Stmt copy_Stmt();
-	void dump(ostream& stream, int n);
-	void dump_with_types(ostream&,int);
+	void dump(DumpWriter& stream, int n);
+	void dump_with_types(DumpWriter&,int);
 	bool isReturnStmt(){return false;}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return false;}
@@ -152,13 +161,14 @@ protected:
     Expr value;
 public:
 	ReturnStmt_class(Expr a2) {
+        kind = K_RETURN;
         value = a2;
     }
 	Expr getValue(){return value;}
     Stmt copy_Stmt();
-	void check(Symbol);
-    void dump_with_types(ostream&,int);
-    void dump(ostream& stream, int n);
+	NodeId lower(CompactAst &);
+    void dump_with_types(DumpWriter&,int);
+    void dump(DumpWriter& stream, int n);
 	bool isReturnStmt(){return true;}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return false;}
@@ -166,11 +176,11 @@ public:
 
 class ContinueStmt_class : public Stmt_class {
 public:
-	ContinueStmt_class() {}
+	ContinueStmt_class() { kind = K_CONTINUE; }
     Stmt copy_Stmt();
-	void check(Symbol);
-    void dump_with_types(ostream&,int);
-    void dump(ostream& stream, int n);
+	NodeId lower(CompactAst &);
+    void dump_with_types(DumpWriter&,int);
+    void dump(DumpWriter& stream, int n);
 	bool isReturnStmt(){return false;}
 	bool isBreakStmt(){return false;}
 	bool isContinueStmt(){return true;}
@@ -179,11 +189,11 @@ public:
 
 class BreakStmt_class : public Stmt_class {
 public:
-	BreakStmt_class() {}
+	BreakStmt_class() { kind = K_BREAK; }
     Stmt copy_Stmt();
-	void check(Symbol);
-    void dump_with_types(ostream&,int);
-    void dump(ostream& stream, int n);
+	NodeId lower(CompactAst &);
+    void dump_with_types(DumpWriter&,int);
+    void dump(DumpWriter& stream, int n);
 	bool isReturnStmt(){return false;}
 	bool isBreakStmt(){return true;}
 	bool isContinueStmt(){return false;}
@@ -9,14 +9,14 @@
 #include "seal.h"
 #include "stringtab.h"
 #define yylineno curr_lineno;
-extern int yylineno;
+extern thread_local int yylineno;
 
 inline Boolean copy_Boolean(Boolean b) {return b; }
 inline void assert_Boolean(Boolean) {}
-inline void dump_Boolean(ostream& stream, int padding, Boolean b)
-	{ stream << pad(padding) << (int) b << "\n"; }
+inline void dump_Boolean(DumpWriter& stream, int padding, Boolean b)
+	{ stream << indent(padding) << (int) b << "\n"; }
 
-void dump_Symbol(ostream& stream, int padding, Symbol b);
+void dump_Symbol(DumpWriter& stream, int padding, Symbol b);
 void assert_Symbol(Symbol b);
 Symbol copy_Symbol(Symbol b);
 
@@ -59,6 +59,25 @@ typedef Actual_class *Actual;
 class Constant_class;
 typedef Constant_class *Constant;
 
+class CompactAst;          // see compact-ast.h
+typedef unsigned int NodeId;
+
+// The kind of an AST node.  Statements and expressions carry theirs in
+// Stmt_class::kind; the compact AST keeps one per node.  The operators
+// from K_ADD to K_BITNOT are contiguous (see operator-rules.h).
+enum NodeKind {
+  K_PROGRAM, K_VARIABLE, K_VARIABLE_DECL, K_CALL_DECL,
+  K_STMT_BLOCK, K_IF, K_WHILE, K_FOR, K_RETURN, K_CONTINUE, K_BREAK,
+  K_ASSIGN,
+  K_ADD, K_MINUS, K_MULTI, K_DIVIDE, K_MOD,
+  K_LT, K_LE, K_EQU, K_NEQ, K_GE, K_GT,
+  K_AND, K_OR, K_XOR, K_BITAND, K_BITOR,
+  K_NEG, K_NOT, K_BITNOT,
+  K_CONST_INT, K_CONST_STRING, K_CONST_FLOAT, K_CONST_BOOL,
+  K_OBJECT, K_CALL, K_ACTUAL, K_NO_EXPR,
+  K_LIST
+};
+
 
 typedef list_node<VariableDecl> VariableDecls_class;
 typedef VariableDecls_class *VariableDecls;
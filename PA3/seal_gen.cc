@@ -0,0 +1,399 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  seal_gen.cc
+//
+//  Writes a random Seal program of a given shape to stdout, for
+//  benchmarking the lexer, parser and semantic checker on inputs of any
+//  size (see bench.sh).  The program is well typed and passes semant,
+//  so every phase runs to the end on it.  The same options and seed
+//  always give the same program.
+//
+//  usage: seal_gen [-f functions] [-s statements] [-d depth] [-n nesting]
+//                  [-l literals] [-c chars] [-i identifiers] [-r seed] [-p]
+//                  [-v]
+//
+//     -f  functions besides main (default 10)
+//     -s  statements in each block (default 10)
+//     -d  depth of expressions (default 3)
+//     -n  how deeply if, while and for may nest (default 2)
+//     -l  percentage of expression leaves that are literals (default 30)
+//     -c  length of string literals, at most 256 (default 8)
+//     -i  identifiers: local variables in each function, which every
+//         function reuses (default 8, at least 4)
+//     -r  seed (default 1)
+//     -p  keep to what the parser of PA2 accepts, which applies &, |
+//         and ~ only to integer constants
+//     -v  printf statements also print a variable of each type, so
+//         that the output of running the program shows its values
+//         (for comparing semant -x with native code, see x86-cgen.h)
+//
+//  Variables are declared at the top of each function; the checker
+//  does not let a function use globals, so the few that are declared
+//  are never used.  Every binary expression is parenthesized.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+enum Type { INT, FLOAT, BOOL, STRING, VOID, TYPES };
+
+static const char *type_names[TYPES] = { "Int", "Float", "Bool", "String",
+                                         "Void" };
+
+struct Function {
+  Type result;
+  std::vector<Type> params;
+};
+
+static int statements = 10;
+static int depth = 3;
+static int nesting = 2;
+static int literal_percent = 30;
+static int string_chars = 8;
+static int identifiers = 8;
+static bool pa2_grammar = false;
+static bool print_values = false;
+
+static std::vector<Function> functions;
+static std::string out;
+
+static unsigned long long seed = 1;
+
+// xorshift64*, so that a seed gives the same program everywhere.
+static unsigned int next_random()
+{
+  seed ^= seed >> 12;
+  seed ^= seed << 25;
+  seed ^= seed >> 27;
+  return (unsigned int) ((seed * 2685821657736338717ull) >> 32);
+}
+
+static int random_below(int n)
+{
+  return next_random() % n;
+}
+
+static bool chance(int percent)
+{
+  return random_below(100) < percent;
+}
+
+static void emit(const char *s)
+{
+  out += s;
+}
+
+static void emit_int(long n)
+{
+  char buf[32];
+  snprintf(buf, sizeof buf, "%ld", n);
+  out += buf;
+}
+
+static void indent(int level)
+{
+  out.append(2 * level, ' ');
+}
+
+// Variable i of the current function has type i % 4.
+static void emit_variable(Type t)
+{
+  int choices = (identifiers - t + 3) / 4;
+  emit("v");
+  emit_int(t + 4 * random_below(choices));
+}
+
+static void emit_literal(Type t)
+{
+  switch (t) {
+  case INT:
+    emit_int(random_below(1000));
+    break;
+  case FLOAT:
+    emit_int(random_below(1000));
+    emit(".");
+    emit_int(random_below(100));
+    break;
+  case BOOL:
+    emit(chance(50) ? "true" : "false");
+    break;
+  default:
+    emit("\"");
+    for (int i = 0; i < string_chars; i++)
+      out += (char) ('a' + random_below(26));
+    emit("\"");
+    break;
+  }
+}
+
+static void emit_expr(Type t, int d);
+
+// A call of a function returning t, or false if there is none.
+static bool emit_call(Type t, int d)
+{
+  int start = random_below(functions.size());
+  for (size_t k = 0; k < functions.size(); k++) {
+    int f = (start + k) % functions.size();
+    if (functions[f].result != t)
+      continue;
+    emit("f");
+    emit_int(f);
+    emit("(");
+    for (size_t p = 0; p < functions[f].params.size(); p++) {
+      if (p)
+        emit(", ");
+      emit_expr(functions[f].params[p], d - 1);
+    }
+    emit(")");
+    return true;
+  }
+  return false;
+}
+
+static void emit_leaf(Type t, int d)
+{
+  if (chance(literal_percent))
+    emit_literal(t);
+  else if (!(chance(5) && emit_call(t, d)))
+    emit_variable(t);
+}
+
+static void emit_binary(Type operands, const char *op, int d)
+{
+  emit("(");
+  emit_expr(operands, d - 1);
+  emit(" ");
+  emit(op);
+  emit(" ");
+  emit_expr(operands, d - 1);
+  emit(")");
+}
+
+static void emit_unary(Type operand, const char *op, int d)
+{
+  emit(op);
+  emit("(");
+  emit_expr(operand, d - 1);
+  emit(")");
+}
+
+static void emit_expr(Type t, int d)
+{
+  static const char *int_ops[] = { "+", "-", "*", "/", "%", "&", "|", "^" };
+  static const char *float_ops[] = { "+", "-", "*", "/" };
+  static const char *compare_ops[] = { "<", "<=", ">", ">=", "==", "!=" };
+  static const char *bool_ops[] = { "&&", "||", "^", "==", "!=" };
+
+  if (d <= 0 || t == STRING || chance(20)) {
+    emit_leaf(t, d);
+    return;
+  }
+  switch (t) {
+  case INT:
+    if (chance(10)) {
+      bool bitnot = chance(50);
+      if (bitnot && pa2_grammar) {
+        emit("~");
+        emit_literal(INT);
+      } else {
+        emit_unary(INT, bitnot ? "~" : "-", d);
+      }
+    } else {
+      const char *op = int_ops[random_below(8)];
+      if (pa2_grammar && (op[0] == '&' || op[0] == '|')) {
+        emit("(");
+        emit_literal(INT);
+        emit(" ");
+        emit(op);
+        emit(" ");
+        emit_literal(INT);
+        emit(")");
+      } else {
+        emit_binary(INT, op, d);
+      }
+    }
+    break;
+  case FLOAT:
+    if (chance(10))
+      emit_unary(FLOAT, "-", d);
+    else
+      emit_binary(FLOAT, float_ops[random_below(4)], d);
+    break;
+  default:
+    if (chance(10))
+      emit_unary(BOOL, "!", d);
+    else if (chance(50))
+      emit_binary(chance(50) ? INT : FLOAT, compare_ops[random_below(6)], d);
+    else
+      emit_binary(BOOL, bool_ops[random_below(5)], d);
+    break;
+  }
+}
+
+static void emit_block(int level, int nest, bool in_loop);
+
+static void emit_statement(int level, int nest, bool in_loop)
+{
+  int kind = random_below(100);
+  indent(level);
+  if (nest > 0 && kind < 8) {
+    emit("if ");
+    emit_expr(BOOL, depth);
+    emit(" ");
+    emit_block(level, nest - 1, in_loop);
+    if (chance(50)) {
+      emit(" else ");
+      emit_block(level, nest - 1, in_loop);
+    }
+    emit("\n");
+  } else if (nest > 0 && kind < 12) {
+    emit("while ");
+    emit_expr(BOOL, depth);
+    emit(" ");
+    emit_block(level, nest - 1, true);
+    emit("\n");
+  } else if (nest > 0 && kind < 16) {
+    emit("for v0 = ");
+    emit_expr(INT, depth);
+    emit("; v0 < ");
+    emit_expr(INT, depth);
+    emit("; v0 = v0 + 1 ");
+    emit_block(level, nest - 1, true);
+    emit("\n");
+  } else if (in_loop && kind < 18) {
+    emit(chance(50) ? "break;\n" : "continue;\n");
+  } else if (kind < 20) {
+    emit("printf(");
+    if (print_values) {
+      emit("\"%d %f %s %s\\n\"");
+      for (int t = 0; t < 4; t++) {
+        emit(", ");
+        emit_variable((Type) t);
+      }
+    } else {
+      emit_literal(STRING);
+    }
+    emit(");\n");
+  } else {
+    Type t = (Type) random_below(4);
+    emit_variable(t);
+    emit(" = ");
+    emit_expr(t, depth);
+    emit(";\n");
+  }
+}
+
+static void emit_block(int level, int nest, bool in_loop)
+{
+  emit("{\n");
+  for (int i = 0; i < statements; i++)
+    emit_statement(level + 1, nest, in_loop);
+  indent(level);
+  emit("}");
+}
+
+static void emit_function(int f)
+{
+  const Function &fn = functions[f];
+  if (f == (int) functions.size() - 1)
+    emit("func main(");
+  else {
+    emit("func f");
+    emit_int(f);
+    emit("(");
+  }
+  for (size_t p = 0; p < fn.params.size(); p++) {
+    if (p)
+      emit(", ");
+    emit("p");
+    emit_int(p);
+    emit(" ");
+    emit(type_names[fn.params[p]]);
+  }
+  emit(") ");
+  emit(type_names[fn.result]);
+  emit(" {\n");
+  for (int i = 0; i < identifiers; i++) {
+    emit("  var v");
+    emit_int(i);
+    emit(" ");
+    emit(type_names[i % 4]);
+    emit(";\n");
+  }
+  for (int i = 0; i < statements; i++)
+    emit_statement(1, nesting, false);
+  emit("  return");
+  if (fn.result != VOID) {
+    emit(" ");
+    emit_expr(fn.result, depth);
+  }
+  emit(";\n}\n\n");
+  if (out.size() >= 1 << 20) {
+    fwrite(out.data(), 1, out.size(), stdout);
+    out.clear();
+  }
+}
+
+static int option(const char *arg, int min, int max)
+{
+  int n = atoi(arg);
+  return n < min ? min : n > max ? max : n;
+}
+
+int main(int argc, char *argv[])
+{
+  int nfunctions = 10;
+  int c;
+  while ((c = getopt(argc, argv, "f:s:d:n:l:c:i:r:pv")) != -1) {
+    switch (c) {
+    case 'f': nfunctions = option(optarg, 0, 1 << 24); break;
+    case 's': statements = option(optarg, 0, 1 << 24); break;
+    case 'd': depth = option(optarg, 0, 64); break;
+    case 'n': nesting = option(optarg, 0, 64); break;
+    case 'l': literal_percent = option(optarg, 0, 100); break;
+    case 'c': string_chars = option(optarg, 0, 256); break;
+    case 'i': identifiers = option(optarg, 4, 1 << 20); break;
+    case 'r': seed = strtoull(optarg, NULL, 10) * 2 + 1; break;
+    case 'p': pa2_grammar = true; break;
+    case 'v': print_values = true; break;
+    default:
+      fprintf(stderr, "usage: seal_gen [-f functions] [-s statements] "
+              "[-d depth] [-n nesting] [-l literals] [-c chars] "
+              "[-i identifiers] [-r seed] [-p] [-v]\n");
+      exit(1);
+    }
+  }
+
+  // The last function is main, which must take nothing and return Void.
+  functions.resize(nfunctions + 1);
+  for (int f = 0; f < nfunctions; f++) {
+    functions[f].result = (Type) random_below(TYPES);
+    int params = random_below(4);
+    for (int p = 0; p < params; p++)
+      functions[f].params.push_back((Type) random_below(4));
+  }
+  functions[nfunctions].result = VOID;
+
+  for (int t = 0; t < 4; t++) {
+    emit("var g");
+    emit_int(t);
+    emit(" ");
+    emit(type_names[t]);
+    emit(";\n");
+  }
+  emit("\n");
+  for (int f = 0; f <= nfunctions; f++)
+    emit_function(f);
+  fwrite(out.data(), 1, out.size(), stdout);
+  return 0;
+}
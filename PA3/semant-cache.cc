@@ -0,0 +1,356 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  semant-cache.cc
+//
+//  The function result cache (see semant-cache.h).  Keys are FNV-1a
+//  hashes.  A function's is taken in one walk over its tree, which
+//  feeds in the kind and line of every node, every name and constant,
+//  and the length of every list.
+//
+//  An entry is a text file:
+//
+//     seal-semant-cache <version>
+//     <names> <types> <diagnostics>
+//     the names of the types in the body and of the arguments of its
+//       diagnostics, one per line
+//     one character per Expr, in the order of the walk, for its type
+//     one line per diagnostic: <code> <line> <op> <argument> <argument>
+//
+//  where a name is given by its number in the list, from 1, and 0 is
+//  none.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <vector>
+#include "semant-cache.h"
+#include "operator-rules.h"
+
+// Bump when the checker changes what it reports, so that old entries
+// are no longer found.
+static const int CACHE_VERSION = 2;
+
+// Types are written one character each, FIRST_CODE for none and
+// FIRST_CODE + k for the k-th name of the entry, all printable.
+static const char FIRST_CODE = '!';
+static const int MAX_NAMES = '~' - FIRST_CODE;
+
+static const CacheKey FNV_OFFSET = 14695981039346656037ULL;
+static const CacheKey FNV_PRIME = 1099511628211ULL;
+
+static CacheKey hash_bytes(CacheKey h, const char *s, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    h ^= (unsigned char) s[i];
+    h *= FNV_PRIME;
+  }
+  return h;
+}
+
+// The name of s followed by a separator, so that adjacent names
+// cannot run together.
+static CacheKey hash_symbol(CacheKey h, Symbol s)
+{
+  if (s)
+    h = hash_bytes(h, s->get_string(), s->get_len());
+  return hash_bytes(h, "\n", 1);
+}
+
+// A whole int at a time, as FNV-1a does a byte.
+static CacheKey hash_int(CacheKey h, int i)
+{
+  return (h ^ (unsigned int) i) * FNV_PRIME;
+}
+
+CacheKey signature_key(Decls decls)
+{
+  CacheKey h = hash_int(FNV_OFFSET, CACHE_VERSION);
+  for (Decl d : *decls) {
+    h = hash_bytes(h, d->isCallDecl() ? "f" : "v", 1);
+    h = hash_symbol(h, d->getName());
+    h = hash_symbol(h, d->getType());
+    if (d->isCallDecl())
+      for (Variable para : *((CallDecl) d)->getVariables())
+        h = hash_symbol(h, para->getType());
+  }
+  return h;
+}
+
+//
+// A walk over a function.  hash sums up what the walk has seen, and
+// exprs gets every Expr of the body, each before its operands.
+//
+struct FunctionWalk {
+  CacheKey hash;
+  std::vector<Expr> exprs;
+};
+
+static void walk_node(FunctionWalk &w, tree_node *t, int kind)
+{
+  w.hash = hash_int(w.hash, kind);
+  w.hash = hash_int(w.hash, t->get_line_number());
+}
+
+static void walk(FunctionWalk &w, Stmt s)
+{
+  walk_node(w, s, s->kind);
+  switch (s->kind) {
+  case K_STMT_BLOCK: {
+    StmtBlock block = (StmtBlock) s;
+    w.hash = hash_int(w.hash, block->getVariableDecls()->len());
+    for (VariableDecl d : *block->getVariableDecls()) {
+      walk_node(w, d, K_VARIABLE_DECL);
+      w.hash = hash_symbol(w.hash, d->getName());
+      w.hash = hash_symbol(w.hash, d->getType());
+    }
+    w.hash = hash_int(w.hash, block->getStmts()->len());
+    for (Stmt t : *block->getStmts())
+      walk(w, t);
+    return;
+  }
+  case K_IF:
+    walk(w, ((IfStmt) s)->getCondition());
+    walk(w, ((IfStmt) s)->getThen());
+    walk(w, ((IfStmt) s)->getElse());
+    return;
+  case K_WHILE:
+    walk(w, ((WhileStmt) s)->getCondition());
+    walk(w, ((WhileStmt) s)->getBody());
+    return;
+  case K_FOR:
+    walk(w, ((ForStmt) s)->getInit());
+    walk(w, ((ForStmt) s)->getCondition());
+    walk(w, ((ForStmt) s)->getLoop());
+    walk(w, ((ForStmt) s)->getBody());
+    return;
+  case K_RETURN:
+    walk(w, ((ReturnStmt) s)->getValue());
+    return;
+  case K_CONTINUE:
+  case K_BREAK:
+    return;
+  }
+
+  w.exprs.push_back((Expr) s);
+  switch (s->kind) {
+  case K_CALL:
+    w.hash = hash_symbol(w.hash, ((Call) s)->getName());
+    w.hash = hash_int(w.hash, ((Call) s)->getActuals()->len());
+    for (Actual a : *((Call) s)->getActuals())
+      walk(w, a);
+    return;
+  case K_ACTUAL:
+    walk(w, ((Actual) s)->getExpr());
+    return;
+  case K_ASSIGN:
+    w.hash = hash_symbol(w.hash, ((Assign_class *) s)->getlValue());
+    walk(w, ((Assign_class *) s)->getValue());
+    return;
+  case K_OBJECT:
+    w.hash = hash_symbol(w.hash, ((Object) s)->getVar());
+    return;
+  case K_CONST_INT:
+    w.hash = hash_symbol(w.hash, ((Const_int_class *) s)->getValue());
+    return;
+  case K_CONST_STRING:
+    w.hash = hash_symbol(w.hash, ((Const_string_class *) s)->getValue());
+    return;
+  case K_CONST_FLOAT:
+    w.hash = hash_symbol(w.hash, ((Const_float_class *) s)->getValue());
+    return;
+  case K_CONST_BOOL:
+    w.hash = hash_int(w.hash, ((Const_bool_class *) s)->getValue());
+    return;
+  }
+  if (is_unary_operator(s->kind)) {
+    walk(w, ((UnaryOp_class *) s)->gete1());
+  } else if (is_operator(s->kind)) {
+    walk(w, ((BinaryOp_class *) s)->gete1());
+    walk(w, ((BinaryOp_class *) s)->gete2());
+  }
+}
+
+static void walk_function(FunctionWalk &w, CallDecl f)
+{
+  walk_node(w, f, K_CALL_DECL);
+  w.hash = hash_symbol(w.hash, f->getName());
+  w.hash = hash_symbol(w.hash, f->getType());
+  w.hash = hash_int(w.hash, f->getVariables()->len());
+  for (Variable para : *f->getVariables()) {
+    walk_node(w, para, K_VARIABLE);
+    w.hash = hash_symbol(w.hash, para->getName());
+    w.hash = hash_symbol(w.hash, para->getType());
+  }
+  walk(w, f->getBody());
+}
+
+CacheKey function_key(CallDecl f, CacheKey signatures,
+                      std::vector<Expr> &exprs)
+{
+  FunctionWalk w;
+  w.hash = signatures;
+  w.exprs.swap(exprs);
+  w.exprs.clear();
+  walk_function(w, f);
+  w.exprs.swap(exprs);
+  return w.hash;
+}
+
+static std::string entry_name(const char *dir, CacheKey key)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx", key);
+  return std::string(dir) + name;
+}
+
+static bool read_file(const std::string &name, std::string &data)
+{
+  FILE *f = fopen(name.c_str(), "rb");
+  if (f == NULL)
+    return false;
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    data.append(buf, n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+bool load_function(const char *dir, CacheKey key, std::vector<Expr> &exprs,
+                   DiagnosticLog &log)
+{
+  std::string data;
+  if (!read_file(entry_name(dir, key), data))
+    return false;
+
+  int version, nnames, ntypes, ndiag;
+  int pos;
+  if (sscanf(data.c_str(), "seal-semant-cache %d\n%d %d %d%n",
+             &version, &nnames, &ntypes, &ndiag, &pos) != 4 ||
+      version != CACHE_VERSION || data[pos++] != '\n' ||
+      nnames < 0 || nnames > MAX_NAMES || ntypes != (int) exprs.size() ||
+      ndiag < 0)
+    return false;
+
+  // Check everything before touching the tree, so a bad entry leaves
+  // nothing behind.
+  Symbol names[MAX_NAMES + 1];
+  names[0] = NULL;
+  for (int k = 1; k <= nnames; k++) {
+    size_t eol = data.find('\n', pos);
+    if (eol == std::string::npos)
+      return false;
+    data[eol] = '\0';
+    names[k] = idtable.find_string(&data[pos]);
+    if (names[k] == NULL)
+      return false;
+    pos = eol + 1;
+  }
+  if (data.size() < pos + (size_t) ntypes + 1 ||
+      data[pos + ntypes] != '\n')
+    return false;
+  const char *codes = &data[pos];
+  for (int i = 0; i < ntypes; i++)
+    if (codes[i] < FIRST_CODE || codes[i] > FIRST_CODE + nnames)
+      return false;
+  pos += ntypes + 1;
+
+  // strtol rather than sscanf, which would measure the rest of the
+  // entry again for every line.
+  DiagnosticLog entry;
+  const char *p = &data[pos];
+  for (int i = 0; i < ndiag; i++) {
+    long field[5];
+    for (int f = 0; f < 5; f++) {
+      char *end;
+      field[f] = strtol(p, &end, 10);
+      if (end == p || *end != (f < 4 ? ' ' : '\n'))
+        return false;
+      p = end + 1;
+    }
+    if (field[0] < 0 || field[0] >= DIAG_CODES || field[2] < 0 ||
+        field[2] > 255 || field[3] < 0 || field[3] > nnames ||
+        field[4] < 0 || field[4] > nnames)
+      return false;
+    entry.report((DiagCode) field[0], field[1], names[field[3]],
+                 names[field[4]], field[2]);
+  }
+  if (p != data.c_str() + data.size())
+    return false;
+
+  for (int i = 0; i < ntypes; i++)
+    exprs[i]->setType(names[codes[i] - FIRST_CODE]);
+  log.append(entry);
+  return true;
+}
+
+// The number of s among names, adding it if it is new; -1 if there
+// would be too many names to encode.
+static int name_number(std::vector<Symbol> &names, Symbol s)
+{
+  size_t k = 0;
+  while (k < names.size() && names[k] != s)
+    k++;
+  if (k == names.size()) {
+    if (k > MAX_NAMES)
+      return -1;
+    names.push_back(s);
+  }
+  return k;
+}
+
+void store_function(const char *dir, CacheKey key, std::vector<Expr> &exprs,
+                    const DiagnosticLog &log)
+{
+  static std::atomic<int> temporaries(0);
+
+  // Number the names: type code FIRST_CODE + k is names[k].  Too many
+  // to encode leaves the function uncached.
+  std::vector<Symbol> names(1, (Symbol) NULL);
+  std::string codes(exprs.size(), FIRST_CODE);
+  for (size_t i = 0; i < exprs.size(); i++) {
+    int k = name_number(names, exprs[i]->getType());
+    if (k < 0)
+      return;
+    codes[i] = FIRST_CODE + k;
+  }
+  std::vector<int> args(2 * log.size());
+  for (int i = 0; i < log.size(); i++)
+    for (int a = 0; a < 2; a++)
+      if ((args[2 * i + a] = name_number(names, log[i].args[a])) < 0)
+        return;
+
+  mkdir(dir, 0777);   // fails harmlessly if it is already there
+  std::string name = entry_name(dir, key);
+  char suffix[48];
+  snprintf(suffix, sizeof(suffix), ".tmp%d.%d", (int) getpid(),
+           temporaries++);
+  std::string temporary = name + suffix;
+
+  FILE *out = fopen(temporary.c_str(), "wb");
+  if (out == NULL)
+    return;
+  fprintf(out, "seal-semant-cache %d\n%d %d %d\n", CACHE_VERSION,
+          (int) names.size() - 1, (int) codes.size(), log.size());
+  for (size_t k = 1; k < names.size(); k++)
+    fprintf(out, "%s\n", names[k]->get_string());
+  fwrite(codes.data(), 1, codes.size(), out);
+  fputc('\n', out);
+  for (int i = 0; i < log.size(); i++)
+    fprintf(out, "%d %d %d %d %d\n", log[i].code, log[i].line, log[i].op,
+            args[2 * i], args[2 * i + 1]);
+  if (fclose(out) != 0 || rename(temporary.c_str(), name.c_str()) != 0)
+    remove(temporary.c_str());
+}
@@ -0,0 +1,66 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef SEMANT_CACHE_H
+#define SEMANT_CACHE_H
+//////////////////////////////////////////////////////////////////////
+//
+//  semant-cache.h
+//
+//  An on-disk cache of what checking each function body produced, so
+//  that running semant again on a file where a few functions changed
+//  (semant -k dir) only checks those functions again.
+//
+//  The result of checking a body depends on the body itself and on the
+//  signatures of the program: the functions in funcT and actualParaT
+//  and the globals in globalVarT.  Each is summed up by a 64-bit
+//  content hash, and a function's key combines the two, so a function
+//  is checked again when its text, its position in the file or any
+//  signature changes.
+//
+//  An entry, stored in dir under the key in hex, holds the diagnostics
+//  of the body (semant-diag.h) and the type the checker gave every Expr
+//  in it, which is replayed into the AST so
+//  that dump_with_types and the backends see the same tree as after a
+//  real check.
+//
+//     CacheKey signature_key(Decls decls)
+//       the hash of the signatures of decls.
+//
+//     CacheKey function_key(CallDecl f, CacheKey signatures, exprs)
+//       the key of f, taken before its body is checked.  Also fills
+//       exprs with the Exprs of the body, for the calls below.
+//
+//     bool load_function(dir, key, exprs, log)
+//       if dir has an entry for key, sets the types of exprs from it,
+//       adds its diagnostics to log and returns true.  A missing or
+//       malformed entry is a miss.
+//
+//     void store_function(dir, key, exprs, log)
+//       records the result of checking the body.  Failing to write the
+//       entry is not an error; the cache just stays cold.
+//
+//  Several threads may load and store at once.  An entry is written to
+//  a temporary file and renamed into place, so readers only ever see
+//  complete entries.  Entries are never removed.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "semant.h"
+#include "semant-diag.h"
+
+typedef unsigned long long CacheKey;
+
+CacheKey signature_key(Decls decls);
+CacheKey function_key(CallDecl f, CacheKey signatures,
+                      std::vector<Expr> &exprs);
+bool load_function(const char *dir, CacheKey key, std::vector<Expr> &exprs,
+                   DiagnosticLog &log);
+void store_function(const char *dir, CacheKey key, std::vector<Expr> &exprs,
+                    const DiagnosticLog &log);
+
+#endif
@@ -0,0 +1,176 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  semant-diag.cc
+//
+//  The records of semant-diag.h and how they are printed.  Everything
+//  is put together in a string first and written to the stream at the
+//  end, so a program with a great many errors costs one write, not one
+//  per error.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include "semant-diag.h"
+#include "operator-rules.h"
+
+// Indexed by DiagCode.  The name of code i is S<i + 1>.
+static const char *formats[DIAG_CODES] = {
+  "Function %0 has been declared previously",
+  "Function %0 has been incorrectly declared due to type error",
+  "Function can not be named \"printf\"",
+  "Global Variable %0 has been declared previously",
+  "Global Variable %0 has been incorrectly declared due to type errors",
+  "Global Variable %0 cannot be declared type void",
+  "Main function is not defined",
+  "Variable cannot be decleared type Void",
+  "Function parameters cannot be declared type Void",
+  "Duplicate Variable Name",
+  "Main Function Should Not Have Params",
+  "Main Function must be defined type Void",
+  "Function Should Have a Return Statement",
+  "Condition of If Statement should be Bool Type",
+  "Condition of While Statement Should be Bool Type",
+  "Condition Expression of For Statement Should be Bool Type",
+  "Need a Return Value!",
+  "Return %0, but need %1",
+  "Continue Statement Must be Used in Loop",
+  "Break Statement Muse be Used in Loop",
+  "function printf() should have at least one parameter",
+  "Function printf() Parameters Should be Type String",
+  "Wrong Number of Parameters",
+  "Parameter type cannot be Void",
+  "Parameter has Wrong type",
+  "function %0has not been declared",
+  "lvalue Undefined",
+  "type of left value and right value should be the same",
+  "object %0 has not been defined",
+  "%o"
+};
+
+void DiagnosticLog::print_message(ostream &s, const Diagnostic &d)
+{
+  for (const char *p = formats[d.code]; *p; p++) {
+    if (*p != '%') {
+      s << *p;
+      continue;
+    }
+    p++;
+    if (*p == 'o') {
+      s << operator_rule(d.op).error;
+    } else {
+      // An Expr that could not be typed has no type to name.
+      Symbol arg = d.args[*p - '0'];
+      if (arg)
+        s << arg;
+      else
+        s << "_no_type";
+    }
+  }
+}
+
+// strcmp order, with no Symbol first.  Not the addresses: those depend
+// on where the strings were allocated, which differs between a single
+// file, -P and a batch.
+static int compare_args(Symbol a, Symbol b)
+{
+  if (a == b)
+    return 0;
+  if (a == NULL || b == NULL)
+    return a == NULL ? -1 : 1;
+  return strcmp(a->get_string(), b->get_string());
+}
+
+// Orders by line, then code, then arguments.
+static bool diag_less(const Diagnostic &a, const Diagnostic &b)
+{
+  if (a.line != b.line)
+    return a.line < b.line;
+  if (a.code != b.code)
+    return a.code < b.code;
+  if (a.op != b.op)
+    return a.op < b.op;
+  int c = compare_args(a.args[0], b.args[0]);
+  if (c != 0)
+    return c < 0;
+  return compare_args(a.args[1], b.args[1]) < 0;
+}
+
+static bool diag_equal(const Diagnostic &a, const Diagnostic &b)
+{
+  return !diag_less(a, b) && !diag_less(b, a);
+}
+
+void DiagnosticLog::sort_unique()
+{
+  std::stable_sort(records.begin(), records.end(), diag_less);
+  records.erase(std::unique(records.begin(), records.end(), diag_equal),
+                records.end());
+}
+
+void DiagnosticLog::print_text(ostream &s)
+{
+  std::ostringstream text;
+  for (size_t i = 0; i < records.size(); i++) {
+    if (records[i].line != NO_LINE)
+      text << records[i].line << ": ";
+    print_message(text, records[i]);
+    text << "\n";
+  }
+  if (stopped)
+    text << "Stopped after " << records.size() << " errors.\n";
+  if (!records.empty())
+    text << "Compilation halted due to static semantic errors.\n";
+  s << text.str();
+  s.flush();
+}
+
+static void print_json_string(ostream &s, const char *p)
+{
+  char escape[8];
+  s << '"';
+  for (; *p; p++) {
+    if (*p == '"' || *p == '\\') {
+      s << '\\' << *p;
+    } else if ((unsigned char) *p < 0x20) {
+      snprintf(escape, sizeof(escape), "\\u%04x", *p);
+      s << escape;
+    } else {
+      s << *p;
+    }
+  }
+  s << '"';
+}
+
+void DiagnosticLog::print_json(ostream &s, const char *filename)
+{
+  std::ostringstream json;
+  char name[16];
+  json << "{\"file\": ";
+  print_json_string(json, filename);
+  json << ", \"errors\": " << records.size() << ", \"diagnostics\": [";
+  for (size_t i = 0; i < records.size(); i++) {
+    std::ostringstream message;
+    print_message(message, records[i]);
+    snprintf(name, sizeof(name), "S%03d", records[i].code + 1);
+    json << (i ? ", " : "") << "{\"code\": \"" << name << "\", \"line\": ";
+    if (records[i].line == NO_LINE)
+      json << "null";
+    else
+      json << records[i].line;
+    json << ", \"message\": ";
+    print_json_string(json, message.str().c_str());
+    json << "}";
+  }
+  json << "], \"stopped\": " << (stopped ? "true" : "false") << "}\n";
+  s << json.str();
+  s.flush();
+}
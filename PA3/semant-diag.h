@@ -0,0 +1,147 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef SEMANT_DIAG_H
+#define SEMANT_DIAG_H
+//////////////////////////////////////////////////////////////////////
+//
+//  semant-diag.h
+//
+//  The diagnostics of the semantic checker.  Instead of being written
+//  as they are found, they are collected as small records, a code, a
+//  line and up to two Symbol arguments, and rendered all at once when
+//  the check is over, as text or as JSON, in one write.
+//
+//  Each DiagCode has a stable name, S001 for the first, S002 for the
+//  second and so on, and a message format, in which %0 and %1 stand
+//  for the arguments and %o for the error of the operator whose kind
+//  is in op (operator-rules.h).  New codes go at the end, so a name
+//  never changes meaning.
+//
+//  DiagnosticLog holds the records:
+//
+//     void report(code, line, a0, a1, op)
+//       appends a record.  line is NO_LINE for a diagnostic that is
+//       about no node in particular.
+//
+//     int size()
+//
+//     void append(const DiagnosticLog &other)
+//       appends other's records, as when the logs of the functions
+//       checked on several threads are put back in source order.
+//
+//     void stop_at(int limit)
+//       keeps the first limit records.  If there were that many, the
+//       check stopped early, and the output says so.
+//
+//     void sort_unique()
+//       sorts the records by line, code and arguments, keeping the
+//       order of the checker among equal ones, and drops the repeats.
+//
+//     void print_text(ostream &s)
+//       "<line>: <message>" per record, as the checker always wrote
+//       them, then the line that says compilation halted, if it did.
+//
+//     void print_json(ostream &s, const char *filename)
+//       one JSON object: the file, the number of errors, every record
+//       with its code, line and message, and whether the check stopped
+//       early.
+//
+//  Both print everything with a single write to s.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "seal-io.h"
+#include "stringtab.h"
+
+enum DiagCode {
+  D_FUNCTION_REDECLARED,
+  D_FUNCTION_BAD_TYPE,
+  D_FUNCTION_NAMED_PRINTF,
+  D_GLOBAL_REDECLARED,
+  D_GLOBAL_BAD_TYPE,
+  D_GLOBAL_VOID,
+  D_NO_MAIN,
+  D_VARIABLE_VOID,
+  D_PARAMETER_VOID,
+  D_DUPLICATE_VARIABLE,
+  D_MAIN_PARAMETERS,
+  D_MAIN_NOT_VOID,
+  D_NO_RETURN,
+  D_IF_CONDITION,
+  D_WHILE_CONDITION,
+  D_FOR_CONDITION,
+  D_RETURN_MISSING,
+  D_RETURN_TYPE,
+  D_CONTINUE_OUTSIDE_LOOP,
+  D_BREAK_OUTSIDE_LOOP,
+  D_PRINTF_NO_ARGUMENTS,
+  D_PRINTF_FORMAT,
+  D_ARGUMENT_COUNT,
+  D_ARGUMENT_VOID,
+  D_ARGUMENT_TYPE,
+  D_UNDECLARED_FUNCTION,
+  D_UNDEFINED_LVALUE,
+  D_ASSIGN_TYPE,
+  D_UNDEFINED_OBJECT,
+  D_OPERATOR_TYPE,
+  DIAG_CODES
+};
+
+// How semant prints them: -D text (the default) or -D json.
+enum DiagnosticFormat { DIAG_TEXT, DIAG_JSON };
+
+const int NO_LINE = -1;
+
+struct Diagnostic {
+  int line;
+  unsigned char code;     // a DiagCode
+  unsigned char op;       // the NodeKind of the operator, for %o
+  Symbol args[2];
+};
+
+class DiagnosticLog {
+private:
+  std::vector<Diagnostic> records;
+  bool stopped;           // the error limit was reached
+
+  void print_message(ostream &s, const Diagnostic &d);
+
+public:
+  DiagnosticLog() : stopped(false) { }
+
+  void report(DiagCode code, int line, Symbol a0 = NULL, Symbol a1 = NULL,
+              int op = 0)
+  {
+    Diagnostic d = { line, (unsigned char) code, (unsigned char) op,
+                     { a0, a1 } };
+    records.push_back(d);
+  }
+
+  int size() const { return records.size(); }
+  const Diagnostic &operator [](int i) const { return records[i]; }
+
+  void append(const DiagnosticLog &other)
+  {
+    records.insert(records.end(), other.records.begin(),
+                   other.records.end());
+  }
+
+  void stop_at(int limit)
+  {
+    if (limit <= size()) {
+      records.resize(limit);
+      stopped = true;
+    }
+  }
+
+  void sort_unique();
+  void print_text(ostream &s);
+  void print_json(ostream &s, const char *filename);
+};
+
+#endif
@@ -1,33 +1,139 @@
 #include <stdio.h>
 #include <unistd.h>    // for getopt
+#include <fstream>
 #include "seal-decl.h"
 #include "seal-expr.h"
 #include "seal-stmt.h"
+#include "binary-ast.h"
+#include "bytecode.h"
+#include "x86-cgen.h"
+#include "c-cgen.h"
+#include "parse-context.h"
+#include "batch.h"
+#include "phase-report.h"
 
-extern Program ast_root;      // root of the abstract syntax tree
-FILE *fin;                    // input file
+thread_local FILE *fin;       // input file
 extern int optind;  // used for option processing (man 3 getopt for more info)
-extern int seal_yyparse(void); // entry point to the AST parser
-extern int omerrs;            // syntax check errors
-char *curr_filename = "<stdin>";
+extern int binary_ast_output; // -B: write the typed AST in binary
+extern char *out_filename;    // -o: where to write it
+extern int mapped_input;      // -m: scan a memory map of the input
+extern int batch_jobs;        // -j: threads to compile a batch on, or -1
+extern int execute_program;   // -x: run the program instead of dumping it
+extern int cgen_debug;        // -c: also list the bytecode on cerr
+extern int assembly_output;   // -S: write x86-64 assembly
+extern int c_output;          // -C: write the program as C
+extern bool disable_reg_alloc; // -r: keep every value on the stack
+thread_local char *curr_filename = "<stdin>";
 
 void handle_flags(int argc, char *argv[]);
 
+// Print the -R report, if one was asked for.
+static void report()
+{
+  if (phase_report != REPORT_NONE) {
+    merge_phase_report();
+    print_phase_report(cerr, phase_report == REPORT_JSON);
+  }
+}
+
 int main(int argc, char *argv[]) {
-  fin = fopen(argv[optind], "r");
-	    if (fin == NULL) {
-		cerr << "Could not open input file " << argv[optind] << endl;
-		exit(1);
-	}
-  curr_lineno = 1;
   handle_flags(argc,argv);
-  seal_yyparse();
-  if(omerrs != 0 || ast_root == NULL){
+  std::vector<char *> files;
+  for (int i = optind; i < argc; i++)
+    add_input(argv[i], files);
+  if (files.empty()) {
+    cerr << "No input files" << endl;
+    exit(1);
+  }
+  if (files.size() > 1 || batch_jobs >= 0 || argv[optind][0] == '@') {
+    if (binary_ast_output || execute_program || assembly_output ||
+        c_output) {
+      cerr << (binary_ast_output ? "-B" : execute_program ? "-x"
+               : assembly_output ? "-S" : "-C")
+           << " takes a single input file" << endl;
+      exit(1);
+    }
+    return compile_batch(files, batch_jobs, mapped_input);
+  }
+
+  ParseContext input(argv[optind], mapped_input);
+  if (!input.parse()) {
+    cerr << "Could not open input file " << argv[optind] << endl;
+    exit(1);
+  }
+  Program ast_root = input.ast_root;
+  if(input.errors != 0 || ast_root == NULL){
     cout << "syntax analyze failed. Please make sure syntax parser passed." << endl;
+    report();
     exit(-1);
   }
-  ast_root->semant();
-  ast_root->dump_with_types(cout,0);
-  fclose(fin);
+  int errors;
+  {
+    PhaseTimer timer(PHASE_SEMANT);
+    errors = ast_root->check_program();
+  }
+  if (errors > 0) {
+    report();
+    exit(1);
+  }
+  if (execute_program) {
+    CompactAst ast;
+    ast_root->lower(ast);
+    Bytecode bc;
+    compile_bytecode(ast, bc);
+    if (cgen_debug)
+      bc.dump(cerr);
+    report();
+    return run_bytecode(bc, stdout);
+  }
+  if (assembly_output) {
+    CompactAst ast;
+    ast_root->lower(ast);
+    Bytecode bc;
+    compile_bytecode(ast, bc);
+    if (cgen_debug)
+      bc.dump(cerr);
+    if (out_filename) {
+      std::ofstream file(out_filename);
+      emit_x86_64(bc, file, !disable_reg_alloc);
+    } else {
+      emit_x86_64(bc, cout, !disable_reg_alloc);
+      cout.flush();
+    }
+    report();
+    return 0;
+  }
+  if (c_output) {
+    CompactAst ast;
+    ast_root->lower(ast);
+    if (out_filename) {
+      std::ofstream file(out_filename);
+      emit_c(ast, file);
+    } else {
+      emit_c(ast, cout);
+      cout.flush();
+    }
+    report();
+    return 0;
+  }
+  {
+    PhaseTimer timer(PHASE_DUMP);
+    if (binary_ast_output) {
+      CompactAst ast;
+      ast_root->lower(ast);
+      if (out_filename) {
+        std::ofstream file(out_filename, std::ios::binary);
+        write_binary_ast(ast, file);
+      } else {
+        write_binary_ast(ast, cout);
+        cout.flush();
+      }
+    } else {
+      DumpWriter out(cout);
+      ast_root->dump_with_types(out,0);
+      out.flush();
+    }
+  }
+  report();
 }
 
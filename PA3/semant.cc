@@ -3,53 +3,123 @@
 #include <stdarg.h>
 #include "semant.h"
 #include "utilities.h"
-#include <unordered_map>
+#include "operator-rules.h"
 #include <vector>
+#include <atomic>
+#include <thread>
+#include "arena.h"
+#include "phase-report.h"
+#include "symbol-map.h"
+#include "semant-cache.h"
+#include "semant-diag.h"
 
 extern int semant_debug;
-extern char *curr_filename;
+extern int semant_threads;
+extern char *semant_cache_dir;
+extern int diagnostic_format;
+extern int error_limit;
+extern int sort_diagnostics;
+extern thread_local char *curr_filename;
+
+typedef HashedSymbolTable<Symbol, Symbol> ObjectEnvironment; // name, type
+typedef SymbolMap<Symbol> FuncTable;
+typedef SymbolMap<Symbol> GlobalVariableTable;
+typedef SymbolMap<Symbol> LocalVariableTable;
+/*mark whether paras are installed*/
+typedef SymbolMap<bool> InstalledTable;
+typedef std::vector<Symbol> ActualPara;
+typedef SymbolMap<ActualPara> ActualParaTable;
 
-static ostream& error_stream = cerr;
-static int semant_errors = 0;
-static Decl curr_decl = 0;
+//////////////////////////////////////////////////////////////////////
+//
+// The state of a check.  A SemantContext holds what the install passes
+// find out about the program, which is only read once they are done,
+// and a SemantWorker per thread checking function bodies: its scopes,
+// the types of the variables of the function it is checking and the
+// log its diagnostics go to (semant-diag.h).
+//
+// Once everything is installed the function bodies are independent,
+// so with semant_threads (-P) above 1 they are checked on a pool of
+// threads.  Each body's diagnostics go to a log of its own, and the
+// logs are put together in source order, so the output is the same
+// whatever the number of threads.
+//
+// With error_limit (-e) no new function is taken once that many errors
+// have been found, and the log is cut at the limit.  Functions are
+// taken in order and every one taken is finished, so the first
+// error_limit diagnostics are the same on any number of threads.
+//
+// With semant_cache_dir (-k) the bodies whose key is in the cache
+// (semant-cache.h) are not checked at all: their diagnostics and
+// types come from the cache, and the others are stored in it.
+//
+// context and worker point at the check running on this thread, so
+// that a batch (see batch.h) can check several programs at once.
+//
+//////////////////////////////////////////////////////////////////////
 
-typedef SymbolTable<Symbol, Symbol> ObjectEnvironment; // name, type
-ObjectEnvironment objectEnv;
+struct SemantWorker {
+    ObjectEnvironment objectEnv;
+    LocalVariableTable localVarT;
+    DiagnosticLog *log;
+    Arena arena;        // for the lists it flattens, off the calling thread
 
-typedef std::unordered_map<Symbol,Symbol> FuncTable;
-FuncTable funcT;
+    SemantWorker() : log(NULL) { }
+};
 
-typedef std::unordered_map<Symbol,Symbol> GlobalVariableTable;
-GlobalVariableTable globalVarT;
+struct SemantContext {
+    FuncTable funcT;
+    GlobalVariableTable globalVarT;
+    InstalledTable installedTable;
+    ActualParaTable actualParaT;
 
-typedef std::unordered_map<Symbol,Symbol> LocalVariableTable;
-LocalVariableTable localVarT;
+    DiagnosticLog log;                      // of the whole program
+    std::atomic<int> errors;                // found so far, on any thread
 
-/*mark whether paras are installed*/
-typedef std::unordered_map<Symbol,bool> InstalledTable;
-InstalledTable installedTable;
+    std::vector<Decl> calls;                // the CallDecls, in order
+    std::vector<DiagnosticLog> call_logs;   // the diagnostics of each
+    std::atomic<size_t> next_call;          // the next one to check
+    std::vector<SemantWorker *> workers;    // [0] is the calling thread
+    CacheKey signatures;                    // with semant_cache_dir
+    std::atomic<int> cache_hits;
+
+    SemantContext() : errors(0), next_call(0), signatures(0), cache_hits(0) { }
+};
+
+static thread_local SemantContext *context = NULL;
+static thread_local SemantWorker *worker = NULL;
 
-typedef std::vector<Symbol> ActualPara;
-typedef std::unordered_map<Symbol,ActualPara> ActualParaTable;
-ActualParaTable actualParaT;
 ///////////////////////////////////////////////
 // helper func
 ///////////////////////////////////////////////
 
+// table[key], or NULL, without adding key to table: workers read the
+// tables of the context at the same time.
+static Symbol find(const SymbolMap<Symbol> &table, Symbol key) {
+    const Symbol *type=table.find(key);
+    return type==NULL ? NULL : *type;
+}
+
+static bool limit_reached() {
+    return error_limit>0 && context->errors>=error_limit;
+}
 
-static ostream& semant_error() {
-    semant_errors++;
-    return error_stream;
+// A log never needs more than error_limit records: past that, they are
+// cut anyway.
+static void report(DiagCode code, int line, Symbol a0, Symbol a1, int op) {
+    context->errors++;
+    if(error_limit<=0 || worker->log->size()<error_limit){
+        worker->log->report(code,line,a0,a1,op);
+    }
 }
 
-static ostream& semant_error(tree_node *t) {
-    error_stream << t->get_line_number() << ": ";
-    return semant_error();
+static void semant_error(DiagCode code) {
+    report(code,NO_LINE,NULL,NULL,0);
 }
 
-static ostream& internal_error(int lineno) {
-    error_stream << "FATAL:" << lineno << ": ";
-    return error_stream;
+static void semant_error(tree_node *t, DiagCode code, Symbol a0 = NULL,
+                         Symbol a1 = NULL, int op = 0) {
+    report(code,t->get_line_number(),a0,a1,op);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -62,7 +132,7 @@ static ostream& internal_error(int lineno) {
 //
 //////////////////////////////////////////////////////////////////////
 
-static Symbol 
+static thread_local Symbol 
     Int,
     Float,
     String,
@@ -98,6 +168,30 @@ static void initialize_constants(void) {
     print        = idtable.add_string("printf");
 }
 
+//
+// The workers of check_calls take the predefined symbols of the thread
+// that started them instead of interning them again: add_string may
+// grow idtable, which other threads are reading.
+//
+struct PredefinedSymbols {
+    Symbol Int, Float, String, Bool, Void, Main, print;
+};
+
+static PredefinedSymbols predefined_symbols(void) {
+    PredefinedSymbols p={Int,Float,String,Bool,Void,Main,print};
+    return p;
+}
+
+static void use_predefined_symbols(const PredefinedSymbols &p) {
+    Int=p.Int;
+    Float=p.Float;
+    String=p.String;
+    Bool=p.Bool;
+    Void=p.Void;
+    Main=p.Main;
+    print=p.print;
+}
+
 /*
     TODO :
     you should fill the following function defines, so that semant() can realize a semantic 
@@ -105,29 +199,28 @@ static void initialize_constants(void) {
     Of course, you can add any other functions to help.
 */
 
-static bool sameType(Symbol name1, Symbol name2) {
-    return strcmp(name1->get_string(), name2->get_string()) == 0;
-}
 
 //pre-install all function's decls
 static void install_calls(Decls decls) {
-    for(int i=decls->first();decls->more(i);i=decls->next(i)){
-        Decl cur_decl=decls->nth(i);
+    for(Decl cur_decl : *decls){
+        if(limit_reached()){
+            return;
+        }
         Symbol name=cur_decl->getName();
         Symbol type=cur_decl->getType();
         
         if(cur_decl->isCallDecl()){
             //if previously defined
-            if(funcT[name]!=NULL){
-                semant_error(cur_decl)<<"Function "<<name<<" has been declared previously"<<endl;
+            if(find(context->funcT,name)!=NULL){
+                semant_error(cur_decl,D_FUNCTION_REDECLARED,name);
             }
-            else if(type!=Int && type!=Float && type != String && type!=Bool && type!=Void){
-                semant_error(cur_decl)<<"Function "<<name<<" has been incorrectly declared due to type error"<<endl;
+            else if(!type_in(type->get_type_id(),TY_DECLARABLE)){
+                semant_error(cur_decl,D_FUNCTION_BAD_TYPE,name);
             }else if(!isValidCallName(name)){
-                semant_error(cur_decl)<<"Function can not be named \"printf\""<<endl;
+                semant_error(cur_decl,D_FUNCTION_NAMED_PRINTF);
             }
-            funcT[name]=type;
-            installedTable[name]=false;
+            context->funcT[name]=type;
+            context->installedTable[name]=false;
             cur_decl->check();
         }
     }
@@ -135,50 +228,129 @@ static void install_calls(Decls decls) {
 
 //pre-install all the global vars
 static void install_globalVars(Decls decls) {
-    for(int i=decls->first();decls->more(i);i=decls->next(i)){
-        Decl cur_decl=decls->nth(i);
+    for(Decl cur_decl : *decls){
+        if(limit_reached()){
+            return;
+        }
         Symbol name=cur_decl->getName();
         Symbol type=cur_decl->getType();
 
         if(!cur_decl->isCallDecl()){
-            if(globalVarT[name]!=NULL){
-                semant_error(cur_decl)<<"Global Variable "<<name<<" has been declared previously"<<endl;
-            }else if(type!=Int && type!=Float && type!=String && type!=Bool && type!= Void){
-                semant_error(cur_decl)<<"Global Variable "<<name<<" has been incorrectly declared due to type errors"<<endl;                
+            if(find(context->globalVarT,name)!=NULL){
+                semant_error(cur_decl,D_GLOBAL_REDECLARED,name);
+            }else if(!type_in(type->get_type_id(),TY_DECLARABLE)){
+                semant_error(cur_decl,D_GLOBAL_BAD_TYPE,name);
             }else if(!isValidTypeName(type)){
-                semant_error(cur_decl)<<"Global Variable "<<name<<" cannot be declared type void"<<endl;
+                semant_error(cur_decl,D_GLOBAL_VOID,name);
             }
-            globalVarT[name]=type;
+            context->globalVarT[name]=type;
         }
     }
 }
 
+// Check the bodies in context->calls until there are none left, or
+// the error limit is reached.  buffered gives each its own log.
+static void check_bodies(bool buffered) {
+    worker->objectEnv.enterscope();
+    size_t i;
+    while(!limit_reached() && (i=context->next_call++)<context->calls.size()){
+        CallDecl call=(CallDecl) context->calls[i];
+        CacheKey key=0;
+        std::vector<Expr> exprs;
+        if(buffered){
+            worker->log=&context->call_logs[i];
+        }
+        if(semant_cache_dir){
+            key=function_key(call,context->signatures,exprs);
+            if(load_function(semant_cache_dir,key,exprs,*worker->log)){
+                context->errors+=worker->log->size();
+                context->cache_hits++;
+                continue;
+            }
+        }
+        worker->localVarT.clear();
+        call->check();
+        // A log cut at the limit is not the whole result.
+        if(semant_cache_dir &&
+           (error_limit<=0 || worker->log->size()<error_limit)){
+            store_function(semant_cache_dir,key,exprs,*worker->log);
+        }
+    }
+    worker->objectEnv.exitscope();
+}
+
+static void check_bodies_on_thread(SemantContext *c, SemantWorker *w,
+                                   PredefinedSymbols symbols) {
+    context=c;
+    worker=w;
+    use_predefined_symbols(symbols);
+    Arena *saved_arena=ast_arena;
+    ast_arena=&w->arena;
+    check_bodies(true);
+    ast_arena=saved_arena;
+    merge_phase_report();
+}
+
 static void check_calls(Decls decls) {
-    objectEnv.enterscope();
-    for(int i=decls->first();decls->more(i);i=decls->next(i)){
-        Decl cur_decl=decls->nth(i);
+    for(Decl cur_decl : *decls){
         if(cur_decl->isCallDecl()){
-            localVarT.clear();
-            cur_decl->check();
+            context->calls.push_back(cur_decl);
         }
     }
-    objectEnv.exitscope();
+    int threads=semant_threads>0 ? semant_threads
+                                 : (int) std::thread::hardware_concurrency();
+    if(threads>(int) context->calls.size()){
+        threads=context->calls.size();
+    }
+    if(threads<=1 && !semant_cache_dir){
+        check_bodies(false);
+        return;
+    }
+    if(semant_cache_dir){
+        context->signatures=signature_key(decls);
+    }
+
+    context->call_logs.resize(context->calls.size());
+    std::vector<std::thread> pool;
+    for(int t=1;t<threads;t++){
+        context->workers.push_back(new SemantWorker());
+        pool.push_back(std::thread(check_bodies_on_thread,context,
+                                   context->workers.back(),
+                                   predefined_symbols()));
+    }
+    check_bodies(true);
+    for(size_t t=0;t<pool.size();t++){
+        pool[t].join();
+    }
+    worker->log=&context->log;
+    for(size_t t=1;t<context->workers.size();t++){
+        // The lists flattened on the other threads belong to the tree.
+        ast_arena->absorb(context->workers[t]->arena);
+        delete context->workers[t];
+    }
+    for(size_t i=0;i<context->call_logs.size();i++){
+        context->log.append(context->call_logs[i]);
+    }
+    if(semant_debug && semant_cache_dir){
+        cerr<<"semant cache: "<<context->cache_hits<<" of "
+            <<context->calls.size()<<" functions"<<endl;
+    }
 }
 
 static void check_main() {
-    if(funcT[Main]==NULL){
-        semant_error()<<"Main function is not defined"<<endl;
+    if(!limit_reached() && find(context->funcT,Main)==NULL){
+        semant_error(D_NO_MAIN);
     }
 }
 
 void VariableDecl_class::check() {
     Symbol name=this->getName();
     Symbol type=this->getType();
-    if(type==Void){
-        semant_error(this)<<"Variable cannot be decleared type Void"<<endl;
+    if(type->get_type_id()==TY_VOID){
+        semant_error(this,D_VARIABLE_VOID);
     }else{
-        objectEnv.addid(name,new Symbol(type));
-        localVarT[name]=type;
+        worker->objectEnv.addid(name,new Symbol(type));
+        worker->localVarT[name]=type;
     }
 }
 
@@ -188,107 +360,113 @@ void CallDecl_class::check() {
     Symbol returnType=this->getType();
     StmtBlock body=this->getBody();
 
-    objectEnv.enterscope();
-    if(!installedTable[funcName]){
+    worker->objectEnv.enterscope();
+    const bool *installed=context->installedTable.find(funcName);
+    if(installed==NULL || !*installed){
         //install paras
         ActualPara actualparaVec;
-        for(int j=vars->first();vars->more(j);j=vars->next(j)){
-            Variable cur_var=vars->nth(j);
+        for(Variable cur_var : *vars){
             Symbol curName=cur_var->getName();
             Symbol curType=cur_var->getType();
-            if(curType==Void){
-                semant_error(this)<<"Function parameters cannot be declared type Void"<<endl;
+            if(curType->get_type_id()==TY_VOID){
+                semant_error(this,D_PARAMETER_VOID);
             }
 
-            if(objectEnv.lookup(curName)!=NULL){
-                semant_error(this)<<"Duplicate Variable Name"<<endl;
+            if(worker->objectEnv.lookup(curName)!=NULL){
+                semant_error(this,D_DUPLICATE_VARIABLE);
             }
-            objectEnv.addid(curName,&curType);
-            localVarT[curName]=curType;
+            worker->objectEnv.addid(curName,&curType);
+            worker->localVarT[curName]=curType;
             actualparaVec.push_back(curType);
         }
-        installedTable[funcName]=true;
-        actualParaT[funcName]=actualparaVec;
+        context->installedTable[funcName]=true;
+        context->actualParaT[funcName]=actualparaVec;
     }else{
-        for(int j=vars->first();vars->more(j);j=vars->next(j)){
-            Variable cur_var=vars->nth(j);
+        for(Variable cur_var : *vars){
             Symbol curName=cur_var->getName();
             Symbol curType=cur_var->getType();
 
-            if(objectEnv.lookup(curName)!=NULL){
-                semant_error(this)<<"Duplicate Variable Name"<<endl;
+            if(worker->objectEnv.lookup(curName)!=NULL){
+                semant_error(this,D_DUPLICATE_VARIABLE);
             }
-            objectEnv.addid(curName,new Symbol (curType));
-            localVarT[curName]=curType;
+            worker->objectEnv.addid(curName,new Symbol (curType));
+            worker->localVarT[curName]=curType;
         }
         //check Main Params
         if(funcName==Main && vars->len()!=0){
-            semant_error(this)<<"Main Function Should Not Have Params"<<endl;
+            semant_error(this,D_MAIN_PARAMETERS);
         }
-        if(funcName==Main && returnType!=Void){
-            semant_error(this)<<"Main Function must be defined type Void"<<endl;
+        if(funcName==Main && returnType->get_type_id()!=TY_VOID){
+            semant_error(this,D_MAIN_NOT_VOID);
         }
 
         //check StmtBlock
         body->check(returnType);
         VariableDecls vars_in_Block=body->getVariableDecls();
-        for(int i=vars_in_Block->first();vars_in_Block->more(i);i=vars_in_Block->next(i)){
-            VariableDecl cur_decl=vars_in_Block->nth(i);
+        for(VariableDecl cur_decl : *vars_in_Block){
             cur_decl->check();
         }
         if(!body->isReturnStmt()){
-            semant_error(this)<<"Function Should Have a Return Statement"<<endl;
+            semant_error(this,D_NO_RETURN);
         }
     }
-    objectEnv.exitscope();
+    worker->objectEnv.exitscope();
 }
 
-void StmtBlock_class::check(Symbol type) {
-    VariableDecls vars=this->getVariableDecls();
-    for(int i=vars->first();vars->more(i);i=vars->next(i)){
-        VariableDecl var=vars->nth(i);
+//////////////////////////////////////////////////////////////////////
+//
+// Statements and expressions are checked by Stmt_class::check and
+// Expr_class::checkType, which switch on the kind tag of the node
+// instead of making a virtual call per node.  The near identical
+// operator checks are a single function driven by the rules in
+// operator-rules.h.
+//
+//////////////////////////////////////////////////////////////////////
+
+static void check_block(StmtBlock block, Symbol type) {
+    VariableDecls vars=block->getVariableDecls();
+    for(VariableDecl var : *vars){
         var->check();
     }
-    this->pass_single_stmt_flag();
-    Stmts stmts=this->getStmts();
+    block->pass_single_stmt_flag();
+    Stmts stmts=block->getStmts();
 
-    for(int i=stmts->first();stmts->more(i);i=stmts->next(i)){
-        Stmt cur_stmt=stmts->nth(i);
+    for(Stmt cur_stmt : *stmts){
         cur_stmt->check(type);
     }
 }
 
-void IfStmt_class::check(Symbol type) {
-    Expr condition=this->getCondition();
-    StmtBlock stmtThen=this->getThen();
-    StmtBlock stmtElse=this->getElse();
+static void check_if(IfStmt stmt, Symbol type) {
+    Expr condition=stmt->getCondition();
+    StmtBlock stmtThen=stmt->getThen();
+    StmtBlock stmtElse=stmt->getElse();
 
-    Symbol conditionType=condition->checkType();
-    if(conditionType!=Bool){
-        semant_error(this)<<"Condition of If Statement should be Bool Type"<<endl;
+    condition->checkType();
+    if(condition->getTypeId()!=TY_BOOL){
+        semant_error(stmt,D_IF_CONDITION);
     }
-    stmtThen->setFlag(this->getLoopFlag());
+    stmtThen->setFlag(stmt->getLoopFlag());
     stmtThen->check(type);
-    stmtElse->setFlag(this->getLoopFlag());
+    stmtElse->setFlag(stmt->getLoopFlag());
     stmtElse->check(type);
 }
 
-void WhileStmt_class::check(Symbol type) {
-    Expr condition=this->getCondition();
-    StmtBlock stmtBody=this->getBody();
-    Symbol conditionType=condition->checkType();
-    if(conditionType!=Bool){
-        semant_error(this)<<"Condition of While Statement Should be Bool Type"<<endl;
+static void check_while(WhileStmt stmt, Symbol type) {
+    Expr condition=stmt->getCondition();
+    StmtBlock stmtBody=stmt->getBody();
+    condition->checkType();
+    if(condition->getTypeId()!=TY_BOOL){
+        semant_error(stmt,D_WHILE_CONDITION);
     }
     stmtBody->setFlag(true);
     stmtBody->check(type);
 }
 
-void ForStmt_class::check(Symbol type) {
-    Expr init=this->getInit();
-    Expr condition=this->getCondition();
-    Expr loopact=this->getLoop();
-    StmtBlock stmtBody=this->getBody();
+static void check_for(ForStmt stmt, Symbol type) {
+    Expr init=stmt->getInit();
+    Expr condition=stmt->getCondition();
+    Expr loopact=stmt->getLoop();
+    StmtBlock stmtBody=stmt->getBody();
     stmtBody->setFlag(true);
 
     init->checkType();
@@ -297,391 +475,232 @@ void ForStmt_class::check(Symbol type) {
         stmtBody->check(type);
         return;
     }else{
-        Symbol conditionType=condition->checkType();
-        if(conditionType!=Bool){
-            semant_error(this)<<"Condition Expression of For Statement Should be Bool Type"<<endl;
+        condition->checkType();
+        if(condition->getTypeId()!=TY_BOOL){
+            semant_error(stmt,D_FOR_CONDITION);
         }
         stmtBody->check(type);
     }
 }
 
-void ReturnStmt_class::check(Symbol type) {
-    Expr value=this->getValue();
+static void check_return(ReturnStmt stmt, Symbol type) {
+    Expr value=stmt->getValue();
     if(value->is_empty_Expr()){
-        if(type!=Void){
-            semant_error(this)<<"Need a Return Value!"<<endl;
+        if(type->get_type_id()!=TY_VOID){
+            semant_error(stmt,D_RETURN_MISSING);
         }
     }else{
         Symbol valueType=value->checkType();
         if(valueType!=type){
-            semant_error(this)<<"Return "<<valueType<<", but need "<<type<<endl;
+            semant_error(stmt,D_RETURN_TYPE,valueType,type);
         }
     }
 }
 
-void ContinueStmt_class::check(Symbol type) {
-    if(!this->getLoopFlag()){
-        semant_error(this)<<"Continue Statement Must be Used in Loop"<<endl;
-    }
-}
-
-void BreakStmt_class::check(Symbol type) {
-    if(!this->getLoopFlag()){
-        semant_error(this)<<"Break Statement Muse be Used in Loop"<<endl;
+void Stmt_class::check(Symbol type) {
+    switch(kind){
+    case K_STMT_BLOCK:
+        check_block((StmtBlock)this,type);
+        break;
+    case K_IF:
+        check_if((IfStmt)this,type);
+        break;
+    case K_WHILE:
+        check_while((WhileStmt)this,type);
+        break;
+    case K_FOR:
+        check_for((ForStmt)this,type);
+        break;
+    case K_RETURN:
+        check_return((ReturnStmt)this,type);
+        break;
+    case K_CONTINUE:
+        if(!this->getLoopFlag()){
+            semant_error(this,D_CONTINUE_OUTSIDE_LOOP);
+        }
+        break;
+    case K_BREAK:
+        if(!this->getLoopFlag()){
+            semant_error(this,D_BREAK_OUTSIDE_LOOP);
+        }
+        break;
+    default:
+        ((Expr)this)->checkType();
+        break;
     }
 }
 
-Symbol Call_class::checkType(){
-    Symbol name=this->getName();
-    Actuals actuals=this->getActuals();
+static Symbol check_call(Call call){
+    Symbol name=call->getName();
+    Actuals actuals=call->getActuals();
     
     if(name==print){
         if(actuals->len()==0){
-            semant_error(this)<<"function printf() should have at least one parameter"<<endl;
-            this->setType(Void);
-            return type;
+            semant_error(call,D_PRINTF_NO_ARGUMENTS);
+            call->setType(Void);
+            return call->getType();
         }
-        Symbol paramType=actuals->nth(actuals->first())->checkType();
-        if(paramType!=String){
-            semant_error(this)<<"Function printf() Parameters Should be Type String"<<endl;
-            this->setType(Void);
-            return type;
+        Actual format=actuals->nth(actuals->first());
+        format->checkType();
+        if(format->getTypeId()!=TY_STRING){
+            semant_error(call,D_PRINTF_FORMAT);
+            call->setType(Void);
+            return call->getType();
         }
-        this->setType(Void);
-        return type;
+        call->setType(Void);
+        return call->getType();
     }
+    const ActualPara *formals=context->actualParaT.find(name);
+    int nformals=formals==NULL ? 0 : formals->size();
     int j=0;
     if(actuals->len()>0){
-        if(actuals->len()!=int(actualParaT[name].size())){
-            semant_error(this)<<"Wrong Number of Parameters"<<endl;
+        if(actuals->len()!=nformals){
+            semant_error(call,D_ARGUMENT_COUNT);
         }
-        for(int i=actuals->first();actuals->more(i);i=actuals->next(i)){
-            Expr expr=actuals->nth(i)->getExpr();
+        for(Actual actual : *actuals){
+            Expr expr=actual->getExpr();
             Symbol exprType=expr->checkType();
-            if(exprType==Void){
-                semant_error(this)<<"Parameter type cannot be Void"<<endl;
+            if(expr->getTypeId()==TY_VOID){
+                semant_error(call,D_ARGUMENT_VOID);
             }
-            if(exprType !=actualParaT[name][j]){
-                semant_error(this)<<"Parameter has Wrong type"<<endl;
+            if(j<nformals && exprType !=(*formals)[j]){
+                semant_error(call,D_ARGUMENT_TYPE);
             }
             j++;
-            actuals->nth(i)->checkType();
+            actual->checkType();
         }
     }
-    if(funcT[name]==NULL){
-        semant_error(this)<<"function "<<name<<"has not been declared"<<endl;
+    Symbol type=find(context->funcT,name);
+    if(type==NULL){
+        semant_error(call,D_UNDECLARED_FUNCTION,name);
     }
-    this->setType(funcT[name]);
-    return type;
+    call->setType(type);
+    return call->getType();
 }
 
-Symbol Actual_class::checkType(){
-    Expr expr=this->getExpr();
-    Symbol exprType=expr->checkType();
-    this->setType(exprType);
-    return type;
-}
-
-Symbol Assign_class::checkType(){
-    Symbol lvalue=this->getlValue();
-    Expr value=this->getValue();
-    if(objectEnv.lookup(lvalue)==NULL && globalVarT[lvalue]==NULL){
-        semant_error(this)<<"lvalue Undefined"<<endl;
+static Symbol check_assign(Assign_class *assign){
+    Symbol lvalue=assign->getlValue();
+    Expr value=assign->getValue();
+    if(worker->objectEnv.lookup(lvalue)==NULL && find(context->globalVarT,lvalue)==NULL){
+        semant_error(assign,D_UNDEFINED_LVALUE);
     }
-    Symbol ls=localVarT[lvalue];
+    Symbol ls=find(worker->localVarT,lvalue);
     Symbol rs=value->checkType();
     
     if(ls!=rs){
-        semant_error(this)<<"type of left value and right value should be the same"<<endl;
+        semant_error(assign,D_ASSIGN_TYPE);
     }
     else{
-        this->setType(rs);
-        return type;
+        assign->setType(rs);
     }
+    return assign->getType();
 }
 
-Symbol Add_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    //deal with default type exchange
-    if(ls!=rs && !(ls==Int && rs==Float)&&!(ls==Float && rs==Int)){
-        //unable to perform type exchange
-        semant_error(this)<<"two expressions in add should have same type"<<endl;
-    }
-    else if((ls==Float && rs==Int)||(ls==Int && rs==Float)){
-        this->setType(Float);
-        return type;
-    }else{
-        this->setType(ls);
-        return type;
+static Symbol check_object(Object object){
+    Symbol var=object->getVar();
+    if(worker->objectEnv.lookup(var)==NULL){
+        semant_error(object,D_UNDEFINED_OBJECT,var);
+        object->setType(Void);
+        return object->getType();
     }
+    Symbol vartype=find(worker->localVarT,var);
+    object->setType(vartype);
+    return object->getType();
 }
 
-Symbol Minus_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    //deal with default type exchange
-    if(ls!=rs && !(ls==Int && rs==Float)&&!(ls==Float && rs==Int)){
-        //unable to perform type exchange
-        semant_error(this)<<"two expressions in minus should have same type"<<endl;
+// l and r are the checked operands; for a unary operator both are its
+// one operand.
+static Symbol check_operator(Expr e, Expr l, Expr r){
+    Symbol ls=l->getType();
+    unsigned char outcome=operator_outcome(e->kind,operand_class(l->getTypeId()),
+                                           operand_class(r->getTypeId()));
+    if((outcome & SAME_ONLY) && ls!=r->getType()){
+        outcome=REJECTED;
     }
-    else if((ls==Float && rs==Int)||(ls==Int && rs==Float)){
-        this->setType(Float);
-        return type;
-    }else{
-        this->setType(ls);
-        return type;
+    if(outcome & REJECTED){
+        semant_error(e,D_OPERATOR_TYPE,NULL,NULL,e->kind);
     }
+    // indexed by OutcomeType; T_NONE leaves the type as it is
+    Symbol result[]={e->getType(),ls,Float,Bool,Int};
+    e->setType(result[outcome & OUTCOME_TYPE]);
+    return e->getType();
 }
 
-Symbol Multi_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    //deal with default type exchange
-    if(ls!=rs && !(ls==Int && rs==Float)&&!(ls==Float && rs==Int)){
-        //unable to perform type exchange
-        semant_error(this)<<"two expressions in multi should have same type"<<endl;
-    }
-    else if((ls==Float && rs==Int)||(ls==Int && rs==Float)){
-        this->setType(Float);
+Symbol Expr_class::checkType(){
+    Expr l,r;
+    switch(kind){
+    case K_CALL:
+        return check_call((Call)this);
+    case K_ACTUAL:
+        setType(((Actual)this)->getExpr()->checkType());
         return type;
-    }else{
-        this->setType(ls);
+    case K_ASSIGN:
+        return check_assign((Assign_class *)this);
+    case K_OBJECT:
+        return check_object((Object)this);
+    case K_CONST_INT:
+        setType(Int);
         return type;
-    }
-}
-
-Symbol Divide_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    //deal with default type exchange
-    if(ls!=rs && !(ls==Int && rs==Float)&&!(ls==Float && rs==Int)){
-        //unable to perform type exchange
-        semant_error(this)<<"two expressions in divide should have same type"<<endl;
-    }
-    else if((ls==Float && rs==Int)||(ls==Int && rs==Float)){
-        this->setType(Float);
+    case K_CONST_STRING:
+        setType(String);
         return type;
-    }else{
-        this->setType(ls);
+    case K_CONST_FLOAT:
+        setType(Float);
         return type;
-    }
-}
-
-Symbol Mod_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-
-    if(ls!=rs && !(ls==Int && rs==Float)&&!(ls==Float && rs==Int)){
-        //unable to perform type exchange
-        semant_error(this)<<"two expressions should in mod have same type"<<endl;
-    }
-    else if((ls==Float && rs==Int)||(ls==Int && rs==Float)){
-        this->setType(Float);
+    case K_CONST_BOOL:
+        setType(Bool);
         return type;
-    }else{
-        this->setType(ls);
+    case K_NO_EXPR:
+        setType(Void);
         return type;
-    }
-}
-
-Symbol Neg_class::checkType(){
-    Expr e1=this->gete1();
-    Symbol valueType=e1->checkType();
-    if(valueType!=Int || valueType!=Float){
-        semant_error(this)<<"TypeError"<<endl;
-    }
-    this->setType(valueType);
-    return type;
-}
-
-Symbol Lt_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float)){
-        semant_error(this)<<"Value Type should be Int or Float"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol Le_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float)){
-        semant_error(this)<<"Value Type should be Int or Float"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol Equ_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if(((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float))&&(ls!=Bool || rs!=Bool)){
-        semant_error(this)<<"Bool equation calculation Type Error"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol Neq_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if(((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float))&&(ls!=Bool || rs!=Bool)){
-        semant_error(this)<<"Bool Nonequation calculation Type Error"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol Ge_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float)){
-        semant_error(this)<<"Value Type should be Int or Float"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol Gt_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if((ls!=Int && ls!=Float)||(rs!=Int && rs!=Float)){
-        semant_error(this)<<"Value Type should be Int or Float"<<endl;
-    }
-    this->setType(Bool);
-    return type;
-}
-
-Symbol And_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-
-    if(ls!=Bool || rs!=Bool){
-        semant_error(this)<<"logical calc values should have type Bool"<<endl;
-    }
-    else{
-        this->setType(Bool);
-        return type;
-    }
-}
-
-Symbol Or_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-
-    if(ls!=Bool || rs!=Bool){
-        semant_error(this)<<"logical calc values should have type Bool"<<endl;
-    }
-    else{
-        this->setType(Bool);
-        return type;
-    }
-}
-
-Symbol Xor_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-    if(!(ls==Bool && rs==Bool)&&!(ls==Int && rs==Int)){
-        semant_error(this)<<"xor calculation wrong type!"<<endl;
-    }
-    else{
-        this->setType(ls);
-        return type;
-    }
-}
+    case K_NEG: case K_NOT: case K_BITNOT:
+        l=((UnaryOp_class *)this)->gete1();
+        l->checkType();
+        return check_operator(this,l,l);
+    default:
+        l=((BinaryOp_class *)this)->gete1();
+        r=((BinaryOp_class *)this)->gete2();
+        l->checkType();
+        r->checkType();
+        return check_operator(this,l,r);
+    }
+}
+
+int Program_class::check_program() {
+    SemantContext program_context;
+    SemantWorker main_worker;
+    context = &program_context;
+    context->workers.push_back(&main_worker);
+    worker = &main_worker;
+    worker->log = &context->log;
 
-Symbol Not_class::checkType(){
-    Symbol ls=e1->checkType();
-    if(ls!=Bool){
-        semant_error(this)<<"Not calc should have type Bool"<<endl;
-    }else{
-        this->setType(Bool);
-        return type;
-    }
-}
-
-Symbol Bitand_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
+    initialize_constants();
+    install_calls(decls);
+    check_main();
+    install_globalVars(decls);
+    check_calls(decls);
 
-    if(!(ls==Int && rs==Int)){
-        semant_error(this)<<"Bit calculation should have type Int"<<endl;
-    }else{
-        this->setType(Int);
-        return type;
+    // Cut first: only the first error_limit are the same on every run.
+    DiagnosticLog &log = context->log;
+    if (error_limit > 0) {
+        log.stop_at(error_limit);
     }
-}
-
-Symbol Bitor_class::checkType(){
-    Symbol ls=e1->checkType();
-    Symbol rs=e2->checkType();
-
-    if(!(ls==Int && rs==Int)){
-        semant_error(this)<<"Bit calculation should have type Int"<<endl;
-    }else{
-        this->setType(Int);
-        return type;
+    if (sort_diagnostics) {
+        log.sort_unique();
     }
-}
-
-Symbol Bitnot_class::checkType(){
-    Symbol ls=e1->checkType();
-    if(ls!=Int){
-        semant_error(this)<<"Bit calculation should have type Int"<<endl;
-    }else{
-        this->setType(Int);
-        return type;
+    if (diagnostic_format == DIAG_JSON) {
+        log.print_json(diagnostics(), curr_filename);
+    } else {
+        log.print_text(diagnostics());
     }
-}
-
-Symbol Const_int_class::checkType(){
-    setType(Int);
-    return type;
-}
-
-Symbol Const_string_class::checkType(){
-    setType(String);
-    return type;
-}
-
-Symbol Const_float_class::checkType(){
-    setType(Float);
-    return type;
-}
-
-Symbol Const_bool_class::checkType(){
-    setType(Bool);
-    return type;
-}
-
-Symbol Object_class::checkType(){
-    if(objectEnv.lookup(var)==NULL){
-        semant_error(this)<<"object "<<var<<" has not been defined"<<endl;
-        this->setType(Void);
-        return type;
-    }
-    Symbol vartype=localVarT[var];
-    this->setType(vartype);
-    return type;
-}
-
-Symbol No_expr_class::checkType(){
-    setType(Void);
-    return getType();
+    int errors = log.size();
+    context = NULL;
+    worker = NULL;
+    return errors;
 }
 
 void Program_class::semant() {
-    initialize_constants();
-    install_calls(decls);
-    check_main();
-    install_globalVars(decls);
-    check_calls(decls);
-    
-    if (semant_errors > 0) {
-        cerr << "Compilation halted due to static semantic errors." << endl;
+    if (check_program() > 0) {
         exit(1);
     }
 }
@@ -0,0 +1,68 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  source-map.cc
+//
+//  Mapping source files for the lexer (see source-map.h).  The space
+//  for the file and its two trailing nulls is reserved first as
+//  anonymous zero pages; the file is then mapped over the start of it.
+//  Whatever follows the end of the file, in its last page or in the
+//  anonymous pages after it, reads as zero, so the trailing nulls need
+//  no writes, even when the file ends exactly on a page boundary.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "source-map.h"
+
+void SourceMap::unmap()
+{
+  if (base)
+    munmap(base, mapped);
+  base = NULL;
+  length = 0;
+  mapped = 0;
+}
+
+bool SourceMap::open(const char *filename)
+{
+  unmap();
+  int fd = ::open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t len = st.st_size;
+  size_t total = (len + 2 + page - 1) / page * page;
+  void *space = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (space == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  if (len > 0 &&
+      mmap(space, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+           fd, 0) == MAP_FAILED) {
+    munmap(space, total);
+    close(fd);
+    return false;
+  }
+  close(fd);
+  base = (char *) space;
+  length = len;
+  mapped = total;
+  return true;
+}
@@ -0,0 +1,66 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+//////////////////////////////////////////////////////////////////////
+//
+//  source-map.h
+//
+//  SourceMap maps a source file into memory so the lexer can scan it
+//  in place, instead of copying it through fread into flex's buffer.
+//  flex wants its buffer to end in two null bytes (YY_END_OF_BUFFER_CHAR)
+//  and writes a null after each token while it is being matched, so
+//  the file is mapped privately and writable, followed by two bytes
+//  of zeroes.  Pages the lexer writes to are copied; the file itself
+//  is never changed.  yytext, and so every identifier and constant
+//  the lexer interns, then points straight into the mapping.
+//
+//     bool open(const char *filename)
+//       maps the file.  Returns false if it cannot be opened or mapped
+//       (a pipe, for instance); the caller then reads it with fread.
+//     char *buffer()        the file, followed by two null bytes
+//     size_t size()         the length of the file
+//     size_t buffer_size()  size() + 2, what yy_scan_buffer wants
+//
+//  The lexer is pointed at a mapping, or back at fin, with
+//
+//     void seal_lex_begin(char *base, size_t size)
+//       defined in seal-lex.cc.  With a NULL base it reads fin.
+//     void seal_lex_end()
+//       lets go of the input and the scanner's buffers; call it
+//       before unmapping, and before a thread that lexed exits.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+
+class SourceMap {
+private:
+  char *base;
+  size_t length;        // of the file
+  size_t mapped;        // bytes of address space reserved at base
+
+  SourceMap(const SourceMap &);             // not copyable
+  SourceMap &operator =(const SourceMap &);
+
+  void unmap();
+
+public:
+  SourceMap() : base(NULL), length(0), mapped(0) { }
+  ~SourceMap() { unmap(); }
+
+  bool open(const char *filename);
+
+  char *buffer()             { return base; }
+  size_t size() const        { return length; }
+  size_t buffer_size() const { return length + 2; }
+};
+
+void seal_lex_begin(char *base, size_t size);
+void seal_lex_end();
+
+#endif
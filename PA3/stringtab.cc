@@ -7,6 +7,7 @@
 #include <assert.h>
 #include "stringtab_functions.h"
 #include "stringtab.h"
+#include "dump-writer.h"
 
 extern char *pad(int n);
 
@@ -19,11 +20,8 @@ template class StringTable<StringEntry>;
 template class StringTable<IntEntry>;
 template class StringTable<FloatEntry>;
 
-Entry::Entry(char *s, int l, int i) : len(l), index(i) {
-  str = new char [len+1];
-  strncpy(str, s, len);
-  str[len] = '\0';
-}
+Entry::Entry(char *s, int l, int i) : str(s), len(l), index(i),
+                                       type_id(TY_NONE) { }
 
 int Entry::equal_string(char *string, int length) const
 {
@@ -71,8 +69,16 @@ void dump_Symbol(ostream& s, int n, Symbol sym)
   s << pad(n) << sym << endl;
 }
 
+void dump_Symbol(DumpWriter& s, int n, Symbol sym)
+{
+  s << indent(n) << sym << '\n';
+}
+
 StringEntry::StringEntry(char *s, int l, int i) : Entry(s,l,i) { }
-IdEntry::IdEntry(char *s, int l, int i) : Entry(s,l,i) { }
+IdEntry::IdEntry(char *s, int l, int i) : Entry(s,l,i)
+{
+  type_id = type_id_of_name(s, l);
+}
 IntEntry::IntEntry(char *s, int l, int i) : Entry(s,l,i) { }
 FloatEntry::FloatEntry(char *s, int l, int i) : Entry(s,l,i) { }
 
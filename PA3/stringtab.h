@@ -11,8 +11,11 @@
 
 #include <assert.h>
 #include <string.h>
-#include "list.h"    // list template
+#include <mutex>
+#include "arena.h"   // storage for entries and their strings
+#include "phase-report.h"
 #include "seal-io.h"
+#include "type-id.h"
 
 class Entry;
 typedef Entry* Symbol;
@@ -31,7 +34,10 @@ protected:
   char *str;     // the string
   int  len;      // the length of the string (without trailing \0)
   int index;     // a unique index for each string
+  unsigned char type_id;   // the TypeId of an IdEntry, else TY_NONE
+  template <class Elem> friend class StringTable;   // assigns shared indices
 public:
+  // s must be null terminated and outlive the Entry; it is not copied.
   Entry(char *s, int l, int i);
 
   // is string argument equal to the str of this Entry?
@@ -42,9 +48,13 @@ public:
 
   ostream& print(ostream& s) const;
 
-  // Return the str and len components of the Entry.
+  // Return the str, len and index components of the Entry.
   char *get_string() const;
   int get_len() const;
+  int get_index() const                     { return index; }
+
+  // The type the string names, worked out when an IdEntry is made.
+  TypeId get_type_id() const                { return (TypeId) type_id; }
 };
 
 //
@@ -100,10 +110,35 @@ template <class Elem>
 class StringTable
 {
 protected:
-   List<Elem> *tbl;   // a string table is a list
+   //
+   // While the table is shared between threads, new strings go to one
+   // of SHARDS independently locked shards, chosen by hash.
+   //
+   enum { SHARD_BITS = 6, SHARDS = 1 << SHARD_BITS };
+   struct Shard {
+      std::mutex lock;
+      Arena arena;    // owns the entries added to this shard
+      Elem **slots;   // hash index over them
+      int capacity;
+      int count;
+      Shard(): slots((Elem **) NULL), capacity(0), count(0) { }
+   };
+
+   Arena arena;       // owns every Entry and its string
    int index;         // the current index
+   Elem **slots;      // open-addressing hash index over the entries
+   int capacity;      // number of slots; zero or a power of two
+   Elem **entries;    // entries[i] is the Entry with index i
+   int entries_size;  // allocated length of entries
+   Shard *shards;     // non-NULL while the table is shared
+
+   void append(Elem *e);   // give e the next index
+   Elem *add_shared(char *s, int len, unsigned int hash);
 public:
-   StringTable(): tbl((List<Elem> *) NULL), index(0) { }   // an empty table
+   StringTable(): index(0),
+                  slots((Elem **) NULL), capacity(0),
+                  entries((Elem **) NULL), entries_size(0),
+                  shards((Shard *) NULL) { }   // an empty table
    // The following methods each add a string to the string table.  
    // Only one copy of each string is maintained.  
    // Returns a pointer to the string table entry with the string.
@@ -125,9 +160,29 @@ public:
 
    Elem *lookup(int index);      // lookup an element using its index
    Elem *lookup_string(char *s); // lookup an element using its string
+   Elem *find_string(char *s);   // the same, but NULL if s is missing
 
    void print();  // print the entire table; for debugging
 
+   // Discard every entry at once.  Symbols handed out earlier dangle.
+   void reset();
+
+   // Between begin_shared() and end_shared(), add_string and
+   // lookup_string may be called from several threads at once, and
+   // every caller gets the same Entry for the same string.  Strings new
+   // to the table get their index only at end_shared(), which numbers
+   // them in strcmp order so the result does not depend on scheduling.
+   // Nothing else may be called while the table is shared.
+   void begin_shared();
+   void end_shared();
+
+   // The number of entries with an index: all of them, unless shared.
+   int size() const { return index; }
+
+   // Bytes and chunks held by the table's arena.
+   size_t bytes_used() const { return arena.bytes_used(); }
+   int chunk_count() const   { return arena.chunk_count(); }
+
 };
 
 class IdTable : public StringTable<IdEntry> { };
@@ -0,0 +1,268 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  stringtab_bench.cc
+//
+//  Interns a large number of distinct identifiers into a fresh IdTable,
+//  then interns every one of them a second time, walks the table by
+//  index, and reports the time spent in each pass together with the
+//  number of operator new calls and the peak resident set size.
+//
+//  usage: stringtab_bench [count [length]]
+//
+//  count defaults to 1000000.  Each identifier is padded to length
+//  characters (default: no padding), so "stringtab_bench 1000000 100"
+//  interns a 100 MB corpus.
+//
+//  usage: stringtab_bench -t threads [count]
+//
+//  Stress test for shared tables: every thread interns the same count
+//  identifiers (default 200000), each starting at a different point,
+//  into one table between begin_shared() and end_shared().  The run
+//  fails unless all threads got the same Entry for every identifier
+//  and the merged indices match those of a second, independent run.
+//
+//  usage: stringtab_bench -m [count [rounds]]
+//
+//  Compares SymbolMap (symbol-map.h) with the unordered_map it replaced
+//  in the semantic checker.  count symbols (default 10000) are interned
+//  and every other one is put in each map; then, rounds times (default
+//  1000), every symbol is looked up, half of them missing, and the map
+//  is cleared and refilled as the checker does per function.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+#include <sys/resource.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include "stringtab.h"
+#include "symbol-map.h"
+#include "seal-parse.h"   // for YYSTYPE
+
+thread_local YYSTYPE seal_yylval; // Not linked with the lexer, so must define this.
+
+static std::atomic<long> new_calls(0);
+
+void *operator new(size_t n)
+{
+  new_calls++;
+  void *p = malloc(n ? n : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept         { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static double seconds_since(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static long peak_rss_kb()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Write the i-th identifier into buf, padded with 'x' to length chars.
+static void make_id(char *buf, int size, int i, int length)
+{
+  int n = snprintf(buf, size, "id_%d", i);
+  while (n < length && n < size - 1)
+    buf[n++] = 'x';
+  buf[n] = '\0';
+}
+
+// Intern count identifiers starting at the first-th, recording the
+// Entry returned for identifier i in got[i].
+static void intern_all(IdTable *table, int count, int first, IdEntryP *got)
+{
+  char buf[32];
+  for (int k = 0; k < count; k++) {
+    int i = (first + k) % count;
+    make_id(buf, sizeof(buf), i, 0);
+    got[i] = table->add_string(buf);
+  }
+}
+
+// One shared interning run; returns the merged index of each identifier.
+static std::vector<int> shared_run(int threads, int count)
+{
+  IdTable table;
+  table.add_string("main");   // present before the table is shared
+  table.begin_shared();
+
+  std::vector< std::vector<IdEntryP> > got(threads,
+                                           std::vector<IdEntryP>(count));
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.push_back(std::thread(intern_all, &table, count,
+                                  (int) ((long) count * t / threads),
+                                  got[t].data()));
+  for (int t = 0; t < threads; t++)
+    workers[t].join();
+  table.end_shared();
+
+  std::vector<int> indices(count);
+  for (int i = 0; i < count; i++) {
+    for (int t = 1; t < threads; t++)
+      if (got[t][i] != got[0][i]) {
+        cerr << "error: identifier " << i << " interned twice\n";
+        exit(1);
+      }
+    indices[i] = got[0][i]->get_index();
+    if (table.lookup(indices[i]) != got[0][i]) {
+      cerr << "error: identifier " << i << " has a bad index\n";
+      exit(1);
+    }
+  }
+  if (table.lookup_string("main")->get_index() != 0) {
+    cerr << "error: existing entry renumbered\n";
+    exit(1);
+  }
+  return indices;
+}
+
+static int stress(int threads, int count)
+{
+  clock_t start = clock();
+  std::vector<int> first = shared_run(threads, count);
+  double run_time = seconds_since(start);
+  if (shared_run(threads, count) != first) {
+    cerr << "error: indices differ between runs\n";
+    return 1;
+  }
+  cout << "interned " << count << " symbols from " << threads
+       << " threads in " << run_time << " s CPU; indices deterministic\n";
+  return 0;
+}
+
+// Look every symbol up in map rounds times, then clear and refill it;
+// returns the number of hits.  MAP is an unordered_map or a SymbolMap.
+template <class MAP>
+static long lookup_rounds(MAP &map, std::vector<Symbol> &syms, int rounds,
+                          double &lookup_time, double &clear_time)
+{
+  long hits = 0;
+  lookup_time = clear_time = 0;
+  for (int r = 0; r < rounds; r++) {
+    clock_t start = clock();
+    for (size_t i = 0; i < syms.size(); i++)
+      if (map.find(syms[i]) != map.end())
+        hits++;
+    lookup_time += seconds_since(start);
+
+    start = clock();
+    map.clear();
+    for (size_t i = 0; i < syms.size(); i += 2)
+      map[syms[i]] = syms[i];
+    clear_time += seconds_since(start);
+  }
+  return hits;
+}
+
+// SymbolMap::find returns a pointer, so it gets an end() to match.
+template <class DAT>
+class SymbolMapAdapter : public SymbolMap<DAT> {
+public:
+  DAT *end() { return (DAT *) NULL; }
+};
+
+static int map_bench(int count, int rounds)
+{
+  IdTable table;
+  char buf[32];
+  std::vector<Symbol> syms;
+  for (int i = 0; i < count; i++) {
+    make_id(buf, sizeof(buf), i, 0);
+    syms.push_back(table.add_string(buf));
+  }
+
+  std::unordered_map<Symbol, Symbol> hashed;
+  SymbolMapAdapter<Symbol> dense;
+  for (int i = 0; i < count; i += 2)
+    hashed[syms[i]] = dense[syms[i]] = syms[i];
+
+  double hashed_lookup, hashed_clear, dense_lookup, dense_clear;
+  long hashed_hits = lookup_rounds(hashed, syms, rounds,
+                                   hashed_lookup, hashed_clear);
+  long dense_hits = lookup_rounds(dense, syms, rounds,
+                                  dense_lookup, dense_clear);
+  if (hashed_hits != dense_hits) {
+    cerr << "error: " << hashed_hits << " hits in unordered_map, "
+         << dense_hits << " in SymbolMap\n";
+    return 1;
+  }
+
+  double lookups = (double) count * rounds;
+  cout << lookups << " lookups of " << count << " symbols, half missing\n";
+  cout << "  unordered_map: " << hashed_lookup << " s ("
+       << lookups / hashed_lookup / 1e6 << " M/s), clear and refill "
+       << hashed_clear << " s\n";
+  cout << "  SymbolMap:     " << dense_lookup << " s ("
+       << lookups / dense_lookup / 1e6 << " M/s), clear and refill "
+       << dense_clear << " s\n";
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 2 && strcmp(argv[1], "-t") == 0)
+    return stress(atoi(argv[2]), argc > 3 ? atoi(argv[3]) : 200000);
+  if (argc > 1 && strcmp(argv[1], "-m") == 0)
+    return map_bench(argc > 2 ? atoi(argv[2]) : 10000,
+                     argc > 3 ? atoi(argv[3]) : 1000);
+
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  int length = argc > 2 ? atoi(argv[2]) : 0;
+  char buf[4096];
+  IdTable table;
+
+  long start_calls = new_calls;
+  clock_t start = clock();
+  for (int i = 0; i < count; i++) {
+    make_id(buf, sizeof(buf), i, length);
+    table.add_string(buf);
+  }
+  double insert_time = seconds_since(start);
+  long insert_calls = new_calls - start_calls;
+
+  start = clock();
+  for (int i = 0; i < count; i++) {
+    make_id(buf, sizeof(buf), i, length);
+    if (table.add_string(buf) != table.lookup_string(buf)) {
+      cerr << "error: " << buf << " interned twice\n";
+      exit(1);
+    }
+  }
+  double hit_time = seconds_since(start);
+
+  start = clock();
+  long total_len = 0;
+  for (int i = table.first(); table.more(i); i = table.next(i))
+    total_len += table.lookup(i)->get_len();
+  double iterate_time = seconds_since(start);
+
+  cout << "interned " << count << " symbols\n";
+  cout << "  insert:  " << insert_time << " s\n";
+  cout << "  hit:     " << hit_time << " s\n";
+  cout << "  iterate: " << iterate_time << " s (" << total_len << " chars)\n";
+  cout << "  operator new calls: " << insert_calls << "\n";
+  cout << "  arena: " << table.bytes_used() << " bytes in "
+       << table.chunk_count() << " chunks\n";
+  cout << "  peak RSS: " << peak_rss_kb() << " KB\n";
+  return 0;
+}
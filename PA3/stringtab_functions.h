@@ -5,15 +5,22 @@
 #include "copyright.h"
 
 #include "seal-io.h"
-#define MAXSIZE 1000000
-#define min(a,b) (a > b ? b : a)
-
 #include "stringtab.h"
 #include <stdio.h>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#define MAXSIZE 1000000
+#define min(a,b) (a > b ? b : a)
 
 //
-// A string table is implemented a linked list of Entrys.  Each Entry
-// in the list has a unique string.
+// A string table is implemented as a dense array of Entrys, ordered by
+// index.  Each Entry in the table has a unique string.  The entries are
+// also indexed by an open addressing hash table (linear probing) so
+// that finding the Entry for a string does not require a scan.  The
+// Entry objects and their strings live in the table's arena, so adding
+// a string costs no individual heap allocation.
 //
 
 template <class Elem>
@@ -23,52 +30,239 @@ Elem *StringTable<Elem>::add_string(char *s)
 }
 
 //
-// Add a string requires two steps.  First, the list is searched; if the
-// string is found, a pointer to the existing Entry for that string is 
-// returned.  If the string is not found, a new Entry is created and added
-// to the list.
+// FNV-1a hash of the first len characters of s.
+//
+static inline unsigned int string_hash(const char *s, int len)
+{
+  unsigned int h = 2166136261u;
+  for (int i = 0; i < len; i++) {
+    h ^= (unsigned char) s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+//
+// A hash index starts with 64 slots and doubles whenever it would
+// become more than 3/4 full.  Entries are rehashed from their strings.
+//
+template <class Elem>
+static void grow_index(Elem **&slots, int &capacity)
+{
+  int newcap = capacity ? capacity * 2 : 64;
+  unsigned int mask = newcap - 1;
+  Elem **newslots = new Elem *[newcap];
+  for (int i = 0; i < newcap; i++)
+    newslots[i] = NULL;
+
+  for (int i = 0; i < capacity; i++) {
+    Elem *e = slots[i];
+    if (e == NULL)
+      continue;
+    unsigned int j = string_hash(e->get_string(), e->get_len()) & mask;
+    while (newslots[j])
+      j = (j + 1) & mask;
+    newslots[j] = e;
+  }
+
+  delete [] slots;
+  slots = newslots;
+  capacity = newcap;
+}
+
+//
+// Probe a hash index for the first len characters of s, whose hash is
+// hash.  Returns the slot holding the matching Entry, or the empty slot
+// where it belongs.  The index must have at least one slot.
+//
+template <class Elem>
+static int probe_index(Elem **slots, int capacity,
+                       char *s, int len, unsigned int hash)
+{
+  unsigned int mask = capacity - 1;
+  unsigned int i = hash & mask;
+  while (slots[i] && !slots[i]->equal_string(s, len))
+    i = (i + 1) & mask;
+  return i;
+}
+
+//
+// Create an Entry and a copy of its string in arena.
+//
+template <class Elem>
+static Elem *new_entry(Arena &arena, char *s, int len, int index)
+{
+  count_alloc(len + 1);
+  count_alloc(sizeof(Elem));
+  char *str = arena.copy_string(s, len);
+  return new (arena.alloc(sizeof(Elem), alignof(Elem))) Elem(str,len,index);
+}
+
+//
+// Record e as the Entry with the next index.
+//
+template <class Elem>
+void StringTable<Elem>::append(Elem *e)
+{
+  if (index == entries_size) {
+    int newsize = entries_size ? entries_size * 2 : 64;
+    Elem **newentries = new Elem *[newsize];
+    for (int i = 0; i < index; i++)
+      newentries[i] = entries[i];
+    delete [] entries;
+    entries = newentries;
+    entries_size = newsize;
+  }
+  e->index = index;
+  entries[index++] = e;
+}
+
+//
+// Add a string requires two steps.  First, the hash index is probed; if
+// the string is found, a pointer to the existing Entry for that string is
+// returned, without modifying the table.  If the string is not found, a
+// new Entry is created in the arena, appended to the entries array and
+// recorded in the empty slot the probe stopped at, after growing the
+// index and probing again if it is too full.
 //
 template <class Elem>
 Elem *StringTable<Elem>::add_string(char *s, int maxchars)
 {
   int len = min((int) strlen(s),maxchars);
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_string(s,len))
-      return l->hd();
+  unsigned int hash = string_hash(s, len);
+  if (shards)
+    return add_shared(s, len, hash);
+
+  int slot = capacity > 0 ? probe_index(slots, capacity, s, len, hash) : -1;
+  if (slot >= 0 && slots[slot])
+    return slots[slot];
+
+  if ((index + 1) * 4 > capacity * 3) {
+    grow_index(slots, capacity);
+    slot = probe_index(slots, capacity, s, len, hash);
+  }
 
-  Elem *e = new Elem(s,len,index++);
-  tbl = new List<Elem>(e, tbl);
+  Elem *e = new_entry<Elem>(arena, s, len, index);
+  slots[slot] = e;
+  append(e);
   return e;
 }
 
 //
-// To look up a string, the list is scanned until a matching Entry is located.
-// If no such entry is found, an assertion failure occurs.  Thus, this function
-// is used only for strings that one expects to find in the table.
+// add_shared is add_string for a shared table.  The main index is not
+// modified while the table is shared, so it is probed without a lock;
+// a string that is not there is added to its shard under the shard's
+// lock, with index -1 until end_shared.
 //
 template <class Elem>
-Elem *StringTable<Elem>::lookup_string(char *s)
+Elem *StringTable<Elem>::add_shared(char *s, int len, unsigned int hash)
+{
+  if (capacity > 0) {
+    int slot = probe_index(slots, capacity, s, len, hash);
+    if (slots[slot])
+      return slots[slot];
+  }
+
+  Shard &shard = shards[hash >> (32 - SHARD_BITS)];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  if ((shard.count + 1) * 4 > shard.capacity * 3)
+    grow_index(shard.slots, shard.capacity);
+
+  int slot = probe_index(shard.slots, shard.capacity, s, len, hash);
+  if (shard.slots[slot] == NULL) {
+    shard.slots[slot] = new_entry<Elem>(shard.arena, s, len, -1);
+    shard.count++;
+  }
+  return shard.slots[slot];
+}
+
+template <class Elem>
+void StringTable<Elem>::begin_shared()
+{
+  assert(shards == NULL);
+  shards = new Shard[SHARDS];
+}
+
+static inline bool entry_less(Entry *a, Entry *b)
+{
+  return strcmp(a->get_string(), b->get_string()) < 0;
+}
+
+//
+// end_shared merges the shards back into the table.  The strings added
+// while it was shared are numbered in strcmp order, after every string
+// that was already present.
+//
+template <class Elem>
+void StringTable<Elem>::end_shared()
+{
+  assert(shards != NULL);
+  std::vector<Elem *> added;
+  for (int i = 0; i < SHARDS; i++) {
+    Shard &shard = shards[i];
+    for (int j = 0; j < shard.capacity; j++)
+      if (shard.slots[j])
+        added.push_back(shard.slots[j]);
+    delete [] shard.slots;
+    arena.absorb(shard.arena);
+  }
+  delete [] shards;
+  shards = NULL;
+
+  std::sort(added.begin(), added.end(), entry_less);
+  for (size_t i = 0; i < added.size(); i++) {
+    Elem *e = added[i];
+    if ((index + 1) * 4 > capacity * 3)
+      grow_index(slots, capacity);
+    int slot = probe_index(slots, capacity, e->get_string(), e->get_len(),
+                           string_hash(e->get_string(), e->get_len()));
+    slots[slot] = e;
+    append(e);
+  }
+}
+
+//
+// To look up a string, the hash index is probed until a matching Entry is
+// located.  find_string returns NULL if there is none; lookup_string
+// fails an assertion instead, and so is used only for strings that one
+// expects to find in the table.
+//
+template <class Elem>
+Elem *StringTable<Elem>::find_string(char *s)
 {
   int len = strlen(s);
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_string(s,len))
-      return l->hd();
-  assert(0);   // fail if string is not found
-  return NULL; // to avoid compiler warning
+  unsigned int hash = string_hash(s, len);
+  Elem *e = NULL;
+  if (capacity > 0)
+    e = slots[probe_index(slots, capacity, s, len, hash)];
+
+  if (e == NULL && shards) {
+    Shard &shard = shards[hash >> (32 - SHARD_BITS)];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.capacity > 0)
+      e = shard.slots[probe_index(shard.slots, shard.capacity, s, len, hash)];
+  }
+  return e;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::lookup_string(char *s)
+{
+  Elem *e = find_string(s);
+  assert(e);   // fail if string is not found
+  return e;
 }
 
 //
 // lookup is similar to lookup_string, but uses the index of the string
-// as the key.
+// as the key.  Indices are dense, so the Entry is read straight out of
+// the entries array.
 //
 template <class Elem>
 Elem *StringTable<Elem>::lookup(int ind)
 {
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_index(ind))
-      return l->hd();
-  assert(0);   // fail if string is not found
-  return NULL; // to avoid compiler warning
+  assert(ind >= 0 && ind < index);   // fail if string is not found
+  return entries[ind];
 }
 
 //
@@ -77,10 +271,11 @@ Elem *StringTable<Elem>::lookup(int ind)
 template <class Elem>
 Elem *StringTable<Elem>::add_int(long i)
 {
-  static char *buf = new char[20];
-  snprintf(buf, 20, "%ld", i);
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%ld", i);
   return add_string(buf);
 }
+
 template <class Elem>
 int StringTable<Elem>::first()
 {
@@ -103,5 +298,24 @@ int StringTable<Elem>::next(int i)
 template <class Elem>
 void StringTable<Elem>::print()
 {
-  list_print(cerr,tbl);
+  cerr << "[\n";
+  for (int i = 0; i < index; i++)
+    cerr << *entries[i] << " ";
+  cerr << "]\n";
 }
+
+//
+// reset empties the table.  The arena keeps its first chunk, and the
+// hash index and entries array keep their size, so refilling the table
+// to a similar size allocates nothing.
+//
+template <class Elem>
+void StringTable<Elem>::reset()
+{
+  assert(shards == NULL);
+  for (int i = 0; i < capacity; i++)
+    slots[i] = NULL;
+  index = 0;
+  arena.reset();
+}
+
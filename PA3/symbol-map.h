@@ -0,0 +1,111 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  symbol-map.h
+//
+//  SymbolMap<DAT> maps Symbols to DATs through an array indexed by the
+//  Symbol's index in its string table, so a query is one bounds check
+//  and one load: no hashing and no node to chase.  All the keys of a
+//  map must come from the same string table.
+//
+//  Each slot carries the generation it was written in, and a slot is
+//  only live if that is the current generation.  clear() just starts a
+//  new generation, which makes it cheap to empty a map used per
+//  function however many symbols the program has.
+//
+//  Strings added to a shared table (stringtab.h) have no index until
+//  end_shared().  Their Symbols are kept in a hash map on the side, so
+//  a map still works inside a batch (batch.h).
+//
+//     DAT *find(Symbol s)
+//       returns s's entry, or NULL if there is none.  Nothing is
+//       inserted, so several threads may call find at once as long as
+//       no thread modifies the map.
+//
+//     DAT &operator [](Symbol s)
+//       returns s's entry, making it a default DAT if there is none.
+//
+//     bool contains(Symbol s)
+//
+//     void clear()
+//       removes every entry, in constant time unless some Symbols had
+//       no index.
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _SYMBOL_MAP_H_
+#define _SYMBOL_MAP_H_
+
+#include <unordered_map>
+#include <vector>
+#include "stringtab.h"
+
+template <class DAT>
+class SymbolMap {
+private:
+  struct Slot {
+    unsigned generation;   // live if equal to the map's generation
+    DAT value;
+    Slot() : generation(0), value() { }
+  };
+
+  std::vector<Slot> slots;                 // slots[i] is for index i
+  unsigned generation;                     // never 0
+  std::unordered_map<Symbol, DAT> unindexed;
+
+public:
+  SymbolMap() : generation(1) { }
+
+  DAT *find(Symbol s)
+  {
+    int i = s->get_index();
+    if (i < 0) {
+      typename std::unordered_map<Symbol, DAT>::iterator it = unindexed.find(s);
+      return it == unindexed.end() ? (DAT *) NULL : &it->second;
+    }
+    if (i >= (int) slots.size() || slots[i].generation != generation)
+      return (DAT *) NULL;
+    return &slots[i].value;
+  }
+
+  const DAT *find(Symbol s) const
+  {
+    return const_cast<SymbolMap *>(this)->find(s);
+  }
+
+  bool contains(Symbol s) const { return find(s) != NULL; }
+
+  DAT &operator [](Symbol s)
+  {
+    int i = s->get_index();
+    if (i < 0)
+      return unindexed[s];
+    if (i >= (int) slots.size())
+      slots.resize(i + 1 > 2 * (int) slots.size() ? i + 1 : 2 * slots.size());
+    Slot &slot = slots[i];
+    if (slot.generation != generation) {
+      slot.generation = generation;
+      slot.value = DAT();
+    }
+    return slot.value;
+  }
+
+  void clear()
+  {
+    if (++generation == 0) {
+      // The stamps wrapped around: make every old slot stale again.
+      for (size_t i = 0; i < slots.size(); i++)
+        slots[i].generation = 0;
+      generation = 1;
+    }
+    if (!unindexed.empty())
+      unindexed.clear();
+  }
+};
+
+#endif
@@ -15,6 +15,9 @@
 #define _SYMTAB_H_
 
 #include "list.h"
+#include "phase-report.h"
+#include <unordered_map>
+#include <vector>
 
 //
 // SymtabEnty<SYM,DAT> defines the entry for a symbol table that associates
@@ -166,5 +169,110 @@ public:
  
 };
 
+//
+// HashedSymbolTable<SYM,DAT> has the same interface as SymbolTable<SYM,DAT>
+//    (except that it cannot be saved with `operator =') but does not walk
+//    the scopes on every query.
+//
+//    `bindings' maps each symbol to a stack of its visible definitions,
+//        innermost last, each tagged with the depth of its scope.
+//
+//    `log' lists the symbols in the order they were added, and `marks'
+//        holds the length of `log' at each `enterscope'.  `exitscope'
+//        pops exactly the definitions made since the matching mark.
+//
+//    `lookup(s)' returns the top of s's stack, and `probe(s)' the top of
+//        s's stack if it belongs to the current scope.  Both take
+//        constant time; `exitscope' takes time proportional to the number
+//        of symbols added to the scope being exited.
+//
+
+template <class SYM, class DAT>
+class HashedSymbolTable
+{
+   struct Binding {
+      DAT *info;
+      int depth;      // number of scopes open when the binding was made
+   };
+   typedef std::vector<Binding> Shadows;
+private:
+   std::unordered_map<SYM, Shadows> bindings;
+   std::vector<SYM> log;
+   std::vector<size_t> marks;
+public:
+   HashedSymbolTable() { }
+
+   void fatal_error(char * msg)
+   {
+     cerr << msg << "\n";
+     exit(1);
+   }
+
+   void enterscope()
+   {
+       marks.push_back(log.size());
+   }
+
+   void exitscope()
+   {
+       // It is an error to exit a scope that doesn't exist.
+       if (marks.empty()) {
+	   fatal_error("exitscope: Can't remove scope from an empty symbol table.");
+       }
+       size_t mark = marks.back();
+       marks.pop_back();
+       while (log.size() > mark) {
+	   bindings[log.back()].pop_back();
+	   log.pop_back();
+       }
+   }
+
+   void addid(SYM s, DAT *i)
+   {
+       // There must be at least one scope to add a symbol.
+       if (marks.empty()) fatal_error("addid: Can't add a symbol without a scope.");
+       Binding b = { i, (int) marks.size() };
+       bindings[s].push_back(b);
+       log.push_back(s);
+   }
+
+   DAT *lookup(SYM s)
+   {
+       phase_counts.lookups++;
+       typename std::unordered_map<SYM, Shadows>::iterator it = bindings.find(s);
+       if (it == bindings.end() || it->second.empty()) {
+	   return NULL;
+       }
+       return it->second.back().info;
+   }
+
+   DAT *probe(SYM s)
+   {
+       if (marks.empty()) {
+	   fatal_error("probe: No scope in symbol table.");
+       }
+       phase_counts.lookups++;
+       typename std::unordered_map<SYM, Shadows>::iterator it = bindings.find(s);
+       if (it == bindings.end() || it->second.empty() ||
+	   it->second.back().depth != (int) marks.size()) {
+	   return NULL;
+       }
+       return it->second.back().info;
+   }
+
+   // Prints out the contents of the symbol table, innermost scope first
+   void dump()
+   {
+      size_t end = log.size();
+      for (size_t k = marks.size(); k > 0; k--) {
+         cerr << "\nScope: \n";
+         for (size_t j = end; j > marks[k-1]; j--) {
+            cerr << "  " << log[j-1] << endl;
+         }
+         end = marks[k-1];
+      }
+   }
+};
+
 #endif
 
@@ -16,7 +16,11 @@
 #include "tree.h"
 
 /* line number to assign to the current node being constructed */
-int node_lineno = 1;
+thread_local int node_lineno = 1;
+
+/* arena that tree nodes are allocated from */
+static Arena default_ast_arena(1 << 20);
+thread_local Arena *ast_arena = &default_ast_arena;
 
 ///////////////////////////////////////////////////////////////////////////
 //
@@ -15,8 +15,12 @@
 ///////////////////////////////////////////////////////////////////////////
  
 
+#include <vector>
+#include "arena.h"
+#include "phase-report.h"
 #include "stringtab.h"
 #include "seal-io.h"
+#include "dump-writer.h"
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -35,10 +39,10 @@
 //         builds a new tree_node.  The type field is NULL, the
 //         line_number is set to the value of the global yylineno.
 //
-//       void dump(ostream& s,int n); 
-//         dump is a pretty printer for tree nodes.  The ostream argument
-//         is the output stream on which the node is to be printed; n is
-//         the number of spaces to indent the output.
+//       void dump(DumpWriter& s,int n); 
+//         dump is a pretty printer for tree nodes.  The DumpWriter
+//         argument is the buffered output on which the node is to be
+//         printed; n is the number of spaces to indent the output.
 //
 //       int get_line_number();  return the line number
 //       Symbol get_type();      return the type 
@@ -47,16 +51,34 @@
 //           sets the line number and type of "this" to the values in
 //           the argument tree_node.  Returns "this".
 //
+//   Tree nodes are allocated from the arena that ast_arena points to and
+//   are never deleted one by one; delete on a node does nothing.  A
+//   driver that compiles many files can point ast_arena at an arena of
+//   its own and reset() it to free a whole tree at once.  Nothing a node
+//   owns lives outside the arena, so no destructor needs to run.
+//   ast_arena, like the line number given to new nodes, is per thread,
+//   so threads that build trees at the same time each need an arena of
+//   their own; ParseContext (parse-context.h) sets one up.
+//
 //
 ////////////////////////////////////////////////////////////////////////////
+extern thread_local Arena *ast_arena;
+
 class tree_node {
 protected:
     int line_number;            // stash the line number when node is made
 public:
+    static void *operator new(size_t size) {
+        phase_counts.nodes++;
+        count_alloc(size);
+        return ast_arena->alloc(size);
+    }
+    static void operator delete(void *) { }
+
     tree_node();
     virtual tree_node *copy() = 0;
     virtual ~tree_node() { }
-    virtual void dump(ostream& stream, int n) = 0;
+    virtual void dump(DumpWriter& stream, int n) = 0;
     int get_line_number();
     tree_node *set(tree_node *);
 };
@@ -89,14 +111,29 @@ public:
 //     for(int i = l->first(); l->more(i); i = l->next(i))
 //         ... operate on l->nth(i) ...
 //
+//     iterator begin();
+//     iterator end();
+//       A list is also a range, so the same loop can be written
+//
+//     for(Elem e : *l)
+//         ... operate on e ...
+//
 //      
 //     int len()
 //     returns the length of the list
 //
 //     nth_length(int n, int &len);
 //     Returns the nth element of the list or NULL if there are not n elements.
-//     "len" is set to the length of the list.  This method is used internally
-//     by the APS package to efficiently traverse the list representation.  
+//     "len" is set to the length of the list.
+//
+//     A list is a tree of nil, single and append nodes, and the parser
+//     builds long left-deep chains of appends.  To keep len, nth and the
+//     iterator constant time, the first of them to be called on a list
+//     flattens it into an array of its elements, which is kept with the
+//     node in ast_arena.  Lists are never modified after they are built,
+//     so the array stays valid.  Flattening walks the tree with an
+//     explicit stack and reuses the array of any sublist that has already
+//     been flattened.
 //
 //     static list_node<Elem> *nil();
 //     static list_node<Elem> *single(Elem);
@@ -113,7 +150,21 @@ public:
 //////////////////////////////////////////////////////////////////////////////
 
 template <class Elem> class list_node : public tree_node {
+protected:
+    Elem *flat;                 // the elements in order, once flattened
+    int flat_len;               // their number, or -1 before flattening
+
+    void flatten();
+    //
+    // Used by flatten(): add the elements of this node to out, or push
+    // its sublists on work, last sublist first.
+    //
+    virtual void expand(std::vector<list_node<Elem> *> &work,
+                        std::vector<Elem> &out) = 0;
 public:
+    typedef const Elem *iterator;
+
+    list_node() : flat(NULL), flat_len(-1) { }
     tree_node *copy()            { return copy_list(); }
     Elem nth(int n);
     //
@@ -122,11 +173,16 @@ public:
     int first()      { return 0; }
     int next(int n)  { return n + 1; }
     int more(int n)  { return (n < len()); }    //whether exists more
+    //
+    // And these make the list a range.
+    //
+    iterator begin() { if (flat_len < 0) flatten(); return flat; }
+    iterator end()   { if (flat_len < 0) flatten(); return flat + flat_len; }
 
     virtual list_node<Elem> *copy_list() = 0;
     virtual ~list_node() { }
-    virtual int len() = 0;
-    virtual Elem nth_length(int n, int &len) = 0;
+    int len()        { if (flat_len < 0) flatten(); return flat_len; }
+    Elem nth_length(int n, int &len);
 
     static list_node<Elem> *nil();
     static list_node<Elem> *single(Elem);
@@ -138,39 +194,56 @@ char *pad(int n);
 extern int info_size;
 
 template <class Elem> class nil_node : public list_node<Elem> {
+protected:
+    void expand(std::vector<list_node<Elem> *> &work, std::vector<Elem> &out);
 public:
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth_length(int n, int &len);
-    void dump(ostream& stream, int n);
+    void dump(DumpWriter& stream, int n);
 };
 
 template <class Elem> class single_list_node : public list_node<Elem> {
     Elem elem;
+protected:
+    void expand(std::vector<list_node<Elem> *> &work, std::vector<Elem> &out);
 public:
     single_list_node(Elem t) {
 	elem = t;
     }
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth_length(int n, int &len);
-    void dump(ostream& stream, int n);
+    void dump(DumpWriter& stream, int n);
 };
 
 
 template <class Elem> class append_node : public list_node<Elem> {
 private:
     list_node<Elem> *some, *rest;
+protected:
+    void expand(std::vector<list_node<Elem> *> &work, std::vector<Elem> &out);
 public:
     append_node(list_node<Elem> *l1, list_node<Elem> *l2) {
 	some = l1;
 	rest = l2;
     }
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth(int n);
-    Elem nth_length(int n, int &len);
-    void dump(ostream& stream, int n);
+    void dump(DumpWriter& stream, int n);
+};
+
+
+//
+// flat_list_node holds its elements in an array from the start.  It is
+// what copy_list makes of an append_node, so copying a long list does
+// not recurse down the append chain.
+//
+template <class Elem> class flat_list_node : public list_node<Elem> {
+protected:
+    void expand(std::vector<list_node<Elem> *> &work, std::vector<Elem> &out);
+public:
+    flat_list_node(Elem *elems, int len) {
+	this->flat = elems;
+	this->flat_len = len;
+    }
+    list_node<Elem> *copy_list();
+    void dump(DumpWriter& stream, int n);
 };
 
 
@@ -196,69 +269,83 @@ template <class Elem> list_node<Elem> *list_node<Elem>::append(list_node<Elem> *
 
 template <class Elem> Elem list_node<Elem>::nth(int n)
 {
-    int len;
-    Elem tmp = nth_length(n ,len);
-
-    if (tmp)
-	return tmp;
+    if (n >= 0 && n < len())
+	return flat[n];
     else {
 	cerr << "error: outside the range of the list\n";
 	exit(1);
     }
 }
 
-// added 10/30/06 cgs
-template <class Elem> Elem append_node<Elem>::nth(int n)
-{
-    int len;
-    Elem tmp = nth_length(n ,len);
-
-    if (tmp)
-	return tmp;
-    else {
-	cerr << "error: outside the range of the list\n";
-	exit(1);
-    }
-}
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::copy_list
+// list_node::nth_length
 //
-// return the deep copy of the nil_node
+// return the nth element on the list, or NULL, and the length of the list
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> list_node<Elem> *nil_node<Elem>::copy_list()
+template <class Elem> Elem list_node<Elem>::nth_length(int n, int &len)
 {
-    return new nil_node<Elem>();
+    len = this->len();
+    if (n >= 0 && n < len)
+	return flat[n];
+    else
+	return NULL;
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::len
+// list_node::flatten
 //
-// return the length of the nil_node
+// collect the elements of the list in order into an array in ast_arena
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> int nil_node<Elem>::len()
+template <class Elem> void list_node<Elem>::flatten()
 {
-    return 0;
+    std::vector<Elem> out;
+    std::vector<list_node<Elem> *> work;
+    work.push_back(this);
+    while (!work.empty()) {
+	list_node<Elem> *l = work.back();
+	work.pop_back();
+	if (l->flat_len >= 0)
+	    out.insert(out.end(), l->flat, l->flat + l->flat_len);
+	else
+	    l->expand(work, out);
+    }
+
+    count_alloc(out.size() * sizeof(Elem));
+    flat = (Elem *) ast_arena->alloc(out.size() * sizeof(Elem), alignof(Elem));
+    for (size_t i = 0; i < out.size(); i++)
+	flat[i] = out[i];
+    flat_len = (int) out.size();
 }
 
+///////////////////////////////////////////////////////////////////////////
+//
+// nil_node::copy_list
+//
+// return the deep copy of the nil_node
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> list_node<Elem> *nil_node<Elem>::copy_list()
+{
+    return new nil_node<Elem>();
+}
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::nth_length
+// nil_node::expand
 //
-// return the nth element on the list
+// a nil_node has no elements
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem nil_node<Elem>::nth_length(int, int &len)
+template <class Elem> void nil_node<Elem>::expand(std::vector<list_node<Elem> *> &,
+						  std::vector<Elem> &)
 {
-    len = 0;
-    return NULL;
 }
 
 
@@ -269,9 +356,9 @@ template <class Elem> Elem nil_node<Elem>::nth_length(int, int &len)
 // dump for list node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> void nil_node<Elem>::dump(ostream& stream, int n)
+template <class Elem> void nil_node<Elem>::dump(DumpWriter& stream, int n)
 {
-    stream << pad(n) << "(nil)\n";
+    stream << indent(n) << "(nil)\n";
 }
 
 
@@ -290,109 +377,130 @@ template <class Elem> list_node<Elem> *single_list_node<Elem>::copy_list()
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::len
+// single_list_node::expand
 //
-// return the length of the single_list_node
+// add the one element of the single_list_node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> int single_list_node<Elem>::len()
+template <class Elem> void single_list_node<Elem>::expand(std::vector<list_node<Elem> *> &,
+							  std::vector<Elem> &out)
 {
-    return 1;
+    out.push_back(elem);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::nth_length
+// single_list_node::dump
 //
-// return the nth element on the list
+// dump for list node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem single_list_node<Elem>::nth_length(int n, int &len)
+template <class Elem> void single_list_node<Elem>::dump(DumpWriter& stream, int n)
 {
-    len = 1;
-    if (n)
-	return NULL;
-    else
-	return elem;
+    elem->dump(stream, n);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::dump
+// append_node::copy_list
 //
-// dump for list node
+// return the deep copy of the append_node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> void single_list_node<Elem>::dump(ostream& stream, int n)
+template <class Elem> list_node<Elem> *append_node<Elem>::copy_list()
 {
-    elem->dump(stream, n);
+    int size = this->len();
+    count_alloc(size * sizeof(Elem));
+    Elem *copy = (Elem *) ast_arena->alloc(size * sizeof(Elem), alignof(Elem));
+
+    for (int i = 0; i < size; i++)
+	copy[i] = (Elem) this->flat[i]->copy();
+    return new flat_list_node<Elem>(copy, size);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// append_node::copy_list
+// append_node::expand
 //
-// return the deep copy of the append_node
+// push both halves of the append_node, the second one first
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> list_node<Elem> *append_node<Elem>::copy_list()
+template <class Elem> void append_node<Elem>::expand(std::vector<list_node<Elem> *> &work,
+						     std::vector<Elem> &)
 {
-    return new append_node<Elem>(some->copy_list(), rest->copy_list());
+    work.push_back(rest);
+    work.push_back(some);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// append_node::len
+// append_node::dump
 //
-// return the length of the append_node
+// dump for list node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> int append_node<Elem>::len()
+template <class Elem> void append_node<Elem>::dump(DumpWriter& stream, int n)
 {
-    return some->len() + rest->len();
+    int i, size;
+
+    size = this->len();
+    stream << indent(n) << "list\n";
+    for (i = 0; i < size; i++)
+      this->nth(i)->dump(stream, n+2);
+    stream << indent(n) << "(end_of_list)\n";
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// append_node::nth_length
+// flat_list_node::copy_list
 //
-// return the nth element on the list
+// return the deep copy of the flat_list_node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem append_node<Elem>::nth_length(int n, int &len)
+template <class Elem> list_node<Elem> *flat_list_node<Elem>::copy_list()
 {
-    int rlen;
-    Elem tmp = some->nth_length(n, len);
+    int size = this->flat_len;
+    count_alloc(size * sizeof(Elem));
+    Elem *copy = (Elem *) ast_arena->alloc(size * sizeof(Elem), alignof(Elem));
 
-    if (!tmp) {
-	tmp = rest->nth_length(n-len, rlen);
-	len += rlen;
-    }
-    return tmp;
+    for (int i = 0; i < size; i++)
+	copy[i] = (Elem) this->flat[i]->copy();
+    return new flat_list_node<Elem>(copy, size);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// append_node::dump
+// flat_list_node::expand
 //
-// dump for list node
+// never called: a flat_list_node is flattened from the start
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> void append_node<Elem>::dump(ostream& stream, int n)
+template <class Elem> void flat_list_node<Elem>::expand(std::vector<list_node<Elem> *> &,
+							std::vector<Elem> &out)
 {
-    int i, size;
+    out.insert(out.end(), this->flat, this->flat + this->flat_len);
+}
 
-    size = len();
-    stream << pad(n) << "list\n";
-    for (i = 0; i < size; i++)
-      nth(i)->dump(stream, n+2);
-    stream << pad(n) << "(end_of_list)\n";
+
+///////////////////////////////////////////////////////////////////////////
+//
+// flat_list_node::dump
+//
+// dump for list node; prints like the append_node it was copied from
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> void flat_list_node<Elem>::dump(DumpWriter& stream, int n)
+{
+    stream << indent(n) << "list\n";
+    for (int i = 0; i < this->flat_len; i++)
+      this->flat[i]->dump(stream, n+2);
+    stream << indent(n) << "(end_of_list)\n";
 }
 
 
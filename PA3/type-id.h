@@ -0,0 +1,60 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef TYPE_ID_H
+#define TYPE_ID_H
+//////////////////////////////////////////////////////////////////////
+//
+//  type-id.h
+//
+//  Seal types as a small set of bits instead of Symbols.  Every
+//  IdEntry works out its TypeId once, when it is interned (stringtab.h),
+//  and every Expr keeps the TypeId of its type next to the Symbol
+//  (seal-expr.h), so the checker tests a type with one load and one
+//  mask instead of comparing strings or a chain of Symbols.
+//
+//  Each type has a bit of its own, so sets of types are masks:
+//
+//     TY_NUMERIC       Int or Float
+//     TY_DECLARABLE    the types a variable or function may be declared
+//                      with, counting Void
+//
+//     TypeId type_id_of_name(s, len)
+//       the TypeId of the identifier s, TY_OTHER if it names no type.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+enum TypeId {
+  TY_NONE   = 0,         // no type yet: an untyped Expr
+  TY_INT    = 1 << 0,
+  TY_FLOAT  = 1 << 1,
+  TY_BOOL   = 1 << 2,
+  TY_STRING = 1 << 3,
+  TY_VOID   = 1 << 4,
+  TY_OTHER  = 1 << 5     // a name that is not a type
+};
+
+const unsigned TY_NUMERIC = TY_INT | TY_FLOAT;
+const unsigned TY_DECLARABLE = TY_INT | TY_FLOAT | TY_BOOL | TY_STRING |
+                               TY_VOID;
+
+inline bool type_in(TypeId t, unsigned set) { return (t & set) != 0; }
+
+inline TypeId type_id_of_name(const char *s, int len)
+{
+  switch (len) {
+  case 3: return memcmp(s, "Int", 3) == 0 ? TY_INT : TY_OTHER;
+  case 4: return memcmp(s, "Bool", 4) == 0 ? TY_BOOL :
+                 memcmp(s, "Void", 4) == 0 ? TY_VOID : TY_OTHER;
+  case 5: return memcmp(s, "Float", 5) == 0 ? TY_FLOAT : TY_OTHER;
+  case 6: return memcmp(s, "String", 6) == 0 ? TY_STRING : TY_OTHER;
+  default: return TY_OTHER;
+  }
+}
+
+#endif
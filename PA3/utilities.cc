@@ -12,6 +12,12 @@
 //
 //  This file contains:
 //      fatal_error            print an error message and exit
+//      diagnostics            where this thread reports lexical, syntax
+//                             and semantic errors (cerr by default)
+//      begin_batch_file       redirect diagnostics for one file of a batch
+//      end_batch_file           and end it
+//      abort_compilation      give up on the compilation: exit, or throw
+//                             CompilationAborted inside a batch file
 //      print_escaped_string   print a string showing escape characters
 //      print_seal_token       print a seal token and its semantic value
 //      dump_seal_token        dump a readable token representation
@@ -24,6 +30,7 @@
 #include "seal-parse.h"  // defines tokens
 #include "stringtab.h"   // Symbol <-> String conversions
 #include "utilities.h"
+#include "phase-report.h"
 
 // #define CHECK_TABLES
 
@@ -39,6 +46,36 @@ void fatal_error(char *msg)
    exit(1);
 }
 
+thread_local PhaseCounts phase_counts;   // see phase-report.h
+
+// The stream diagnostics go to on this thread while a batch driver is
+// compiling a file here, or NULL.
+static thread_local ostream *batch_diagnostics = NULL;
+
+ostream& diagnostics()
+{
+   return batch_diagnostics ? *batch_diagnostics : cerr;
+}
+
+void begin_batch_file(ostream& diag)
+{
+   batch_diagnostics = &diag;
+}
+
+void end_batch_file()
+{
+   batch_diagnostics = NULL;
+}
+
+void abort_compilation(int status)
+{
+   if (batch_diagnostics) {
+      CompilationAborted aborted = { status };
+      throw aborted;
+   }
+   exit(status);
+}
+
 
 void print_escaped_string(ostream& str, const char *s)
 {
@@ -130,48 +167,48 @@ char *seal_token_to_string(int tok)
 void print_seal_token(int tok)
 {
 
-  cerr << seal_token_to_string(tok);
+  diagnostics() << seal_token_to_string(tok);
 
   switch (tok) {
   case (CONST_STRING):
-    cerr << " = ";
-    cerr << " \"";
-    print_escaped_string(cerr, seal_yylval.symbol->get_string());
-    cerr << "\"";
+    diagnostics() << " = ";
+    diagnostics() << " \"";
+    print_escaped_string(diagnostics(), seal_yylval.symbol->get_string());
+    diagnostics() << "\"";
 #ifdef CHECK_TABLES
     stringtable.lookup_string(seal_yylval.symbol->get_string());
 #endif
     break;
   case (CONST_INT):
-    cerr << " = " << seal_yylval.symbol;
+    diagnostics() << " = " << seal_yylval.symbol;
 #ifdef CHECK_TABLES
     inttable.lookup_string(seal_yylval.symbol->get_string());
 #endif
     break;
   case (CONST_FLOAT):
-    cerr << " = " << seal_yylval.symbol;
+    diagnostics() << " = " << seal_yylval.symbol;
 #ifdef CHECK_TABLES
     floattable.lookup_string(seal_yylval.symbol->get_string());
 #endif
     break;
   case (CONST_BOOL):
-    cerr << (seal_yylval.boolean ? " = true" : " = false");
+    diagnostics() << (seal_yylval.boolean ? " = true" : " = false");
     break;
   case (OBJECTID):
-    cerr << " = " << seal_yylval.symbol;
+    diagnostics() << " = " << seal_yylval.symbol;
 #ifdef CHECK_TABLES
     idtable.lookup_string(seal_yylval.symbol->get_string());
 #endif
     break;
   case (TYPEID):
-    cerr << " = " << seal_yylval.symbol;
+    diagnostics() << " = " << seal_yylval.symbol;
 #ifdef CHECK_TABLES
     idtable.lookup_string(seal_yylval.symbol->get_string());
 #endif
     break;
   case (ERROR): 
-    cerr << " = ";
-    print_escaped_string(cerr, seal_yylval.error_msg);
+    diagnostics() << " = ";
+    print_escaped_string(diagnostics(), seal_yylval.error_msg);
     break;
   }
 }
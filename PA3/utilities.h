@@ -13,8 +13,20 @@
 extern char *seal_token_to_string(int tok);
 extern void print_seal_token(int tok);
 extern void fatal_error(char *);
+extern ostream& diagnostics();
+extern void begin_batch_file(ostream& diag);
+extern void end_batch_file();
+extern void abort_compilation(int status);
 extern void print_escaped_string(ostream& str, const char *s);
 extern char *pad(int);
+//
+// Thrown by abort_compilation in place of exit while a batch driver
+// (see batch.h) is compiling a file on the calling thread.
+//
+struct CompilationAborted {
+  int status;
+};
+
 /*  On some machines strdup is not in the standard library. */
 //char *strdup(const char *s);
 
@@ -0,0 +1,149 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  vm.cc
+//
+//  The interpreter for the bytecode of bytecode.h.  Every handler ends
+//  by jumping straight to the handler of the next instruction through
+//  the labels table, so the branch predictor sees one indirect jump per
+//  handler instead of one shared switch.  Register windows live on one
+//  stack of Values; a call only moves the window base.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "bytecode.h"
+#include "utilities.h"
+
+const int STACK_VALUES = 1 << 20;
+
+struct Frame {
+  const Instr *return_to;
+  Value *regs;
+};
+
+static void runtime_error(Bytecode &bc, const Instr *ip, FILE *out,
+                          const char *message)
+{
+  fflush(out);
+  diagnostics() << bc.lines[ip - &bc.code[0]] << ": runtime error: "
+                << message << "\n";
+  abort_compilation(1);
+}
+
+int run_bytecode(Bytecode &bc, FILE *out)
+{
+#define OPCODE_LABEL(op) &&do_##op,
+  static void *labels[NUM_OPCODES] = { OPCODES(OPCODE_LABEL) };
+#undef OPCODE_LABEL
+
+  if (bc.main < 0)
+    return 0;
+  std::vector<Value> stack(STACK_VALUES);
+  std::vector<Frame> frames;
+  Value *limit = &stack[0] + STACK_VALUES;
+  const Instr *code = &bc.code[0];
+  const Value *k = bc.constants.empty() ? NULL : &bc.constants[0];
+  BytecodeFunction &main = bc.functions[bc.main];
+  Value *r = &stack[0];
+  const Instr *ip = code + main.entry;
+  const Instr *i;
+
+  if (main.registers > STACK_VALUES)
+    runtime_error(bc, ip, out, "stack overflow");
+
+#define NEXT goto *labels[(i = ip++)->op]
+#define INT_OP(name, op)                                             \
+  do_##name:                                                         \
+    r[i->a].i = (long) ((unsigned long) r[i->b].i op                 \
+                        (unsigned long) r[i->c].i);                  \
+    NEXT;
+#define FLOAT_OP(name, op)                                           \
+  do_##name: r[i->a].f = r[i->b].f op r[i->c].f; NEXT;
+#define COMPARE(name, field, op)                                     \
+  do_##name: r[i->a].i = r[i->b].field op r[i->c].field; NEXT;
+
+  NEXT;
+
+do_MOV: r[i->a] = r[i->b]; NEXT;
+do_LOADK: r[i->a] = k[i->bc()]; NEXT;
+INT_OP(ADD_I, +)
+INT_OP(SUB_I, -)
+INT_OP(MUL_I, *)
+do_DIV_I:
+  if (r[i->c].i == 0)
+    runtime_error(bc, i, out, "division by zero");
+  // LONG_MIN / -1 overflows; it wraps like the other operators.
+  r[i->a].i = r[i->c].i == -1 ? (long) -(unsigned long) r[i->b].i
+                              : r[i->b].i / r[i->c].i;
+  NEXT;
+do_MOD_I:
+  if (r[i->c].i == 0)
+    runtime_error(bc, i, out, "division by zero");
+  r[i->a].i = r[i->c].i == -1 ? 0 : r[i->b].i % r[i->c].i;
+  NEXT;
+FLOAT_OP(ADD_F, +)
+FLOAT_OP(SUB_F, -)
+FLOAT_OP(MUL_F, *)
+FLOAT_OP(DIV_F, /)
+do_MOD_F: r[i->a].f = fmod(r[i->b].f, r[i->c].f); NEXT;
+do_AND: r[i->a].i = r[i->b].i & r[i->c].i; NEXT;
+do_OR: r[i->a].i = r[i->b].i | r[i->c].i; NEXT;
+do_XOR: r[i->a].i = r[i->b].i ^ r[i->c].i; NEXT;
+do_NEG_I: r[i->a].i = (long) -(unsigned long) r[i->b].i; NEXT;
+do_NEG_F: r[i->a].f = -r[i->b].f; NEXT;
+do_NOT: r[i->a].i = !r[i->b].i; NEXT;
+do_BITNOT: r[i->a].i = ~r[i->b].i; NEXT;
+do_I2F: r[i->a].f = (double) r[i->b].i; NEXT;
+COMPARE(LT_I, i, <)
+COMPARE(LE_I, i, <=)
+COMPARE(GT_I, i, >)
+COMPARE(GE_I, i, >=)
+COMPARE(EQ_I, i, ==)
+COMPARE(NE_I, i, !=)
+COMPARE(LT_F, f, <)
+COMPARE(LE_F, f, <=)
+COMPARE(GT_F, f, >)
+COMPARE(GE_F, f, >=)
+COMPARE(EQ_F, f, ==)
+COMPARE(NE_F, f, !=)
+do_JMP: ip = code + i->bc(); NEXT;
+do_JT: if (r[i->a].i) ip = code + i->bc(); NEXT;
+do_JF: if (!r[i->a].i) ip = code + i->bc(); NEXT;
+do_CALL: {
+    BytecodeFunction &f = bc.functions[i->bc()];
+    Value *callee = r + i->a;
+    if (callee + f.registers > limit)
+      runtime_error(bc, i, out, "stack overflow");
+    memset(callee + f.params, 0, (f.registers - f.params) * sizeof(Value));
+    Frame frame = { ip, r };
+    frames.push_back(frame);
+    r = callee;
+    ip = code + f.entry;
+    NEXT;
+  }
+do_RET:
+  r[0] = r[i->a];
+do_RET_VOID:
+  if (frames.empty())
+    return 0;
+  ip = frames.back().return_to;
+  r = frames.back().regs;
+  frames.pop_back();
+  NEXT;
+do_PRINTF:
+  seal_print(out, r + i->a, bc.print_types[i->c].c_str());
+  NEXT;
+
+#undef NEXT
+#undef INT_OP
+#undef FLOAT_OP
+#undef COMPARE
+}
@@ -0,0 +1,101 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  vm_bench.cc
+//
+//  Parses and checks a Seal program exactly as semant does, compiles it
+//  to bytecode (see bytecode.h) and runs it, reporting:
+//
+//    - the time semant() took, and the time to lower the typed tree
+//      and compile it;
+//    - the size of the bytecode: instructions, constants and bytes;
+//    - the best run time of main, with printf writing to /dev/null.
+//
+//  usage: vm_bench file [rounds]
+//
+//  rounds (default 5) is the number of times the program is run; the
+//  best round is reported.  Loop-heavy programs such as test/test1.seal,
+//  or the ones written by seal_gen with deep nesting, show the cost of
+//  dispatch best.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <time.h>
+#include "seal-decl.h"
+#include "seal-expr.h"
+#include "seal-stmt.h"
+#include "compact-ast.h"
+#include "bytecode.h"
+
+extern thread_local Program ast_root; // root of the abstract syntax tree
+thread_local FILE *fin;       // input file
+extern int seal_yyparse(void); // entry point to the AST parser
+extern thread_local int omerrs; // syntax check errors
+extern int optind;  // used for option processing (man 3 getopt for more info)
+thread_local char *curr_filename = "<stdin>";
+
+void handle_flags(int argc, char *argv[]);
+
+static double seconds_since(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+  handle_flags(argc, argv);
+  if (optind >= argc) {
+    cerr << "usage: vm_bench file [rounds]\n";
+    exit(1);
+  }
+  int rounds = optind + 1 < argc ? atoi(argv[optind + 1]) : 5;
+  fin = fopen(argv[optind], "r");
+  if (fin == NULL) {
+    cerr << "Could not open input file " << argv[optind] << endl;
+    exit(1);
+  }
+  curr_filename = argv[optind];
+  curr_lineno = 1;
+  seal_yyparse();
+  fclose(fin);
+  if (omerrs != 0 || ast_root == NULL) {
+    cout << "syntax analyze failed. Please make sure syntax parser passed." << endl;
+    exit(-1);
+  }
+  clock_t start = clock();
+  ast_root->semant();
+  double check_time = seconds_since(start);
+
+  start = clock();
+  CompactAst ast;
+  ast_root->lower(ast);
+  Bytecode bc;
+  compile_bytecode(ast, bc);
+  double compile_time = seconds_since(start);
+
+  FILE *null_out = fopen("/dev/null", "w");
+  double run = 1e30;
+  for (int r = 0; r < rounds; r++) {
+    start = clock();
+    run_bytecode(bc, null_out);
+    fflush(null_out);
+    double t = seconds_since(start);
+    if (t < run)
+      run = t;
+  }
+  fclose(null_out);
+
+  printf("semant:   %.6f s\n", check_time);
+  printf("compile:  %.6f s\n", compile_time);
+  printf("bytecode: %zu instructions, %zu constants, %zu functions, "
+         "%zu bytes\n", bc.code.size(), bc.constants.size(),
+         bc.functions.size(),
+         bc.code.size() * sizeof(Instr) + bc.constants.size() * sizeof(Value));
+  printf("run:      %.6f s (best of %d)\n", run, rounds);
+  return 0;
+}
@@ -0,0 +1,870 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  x86-cgen.cc
+//
+//  The x86-64 code generator (see x86-cgen.h).  Each function is done
+//  in four steps: its instructions are copied into Operations with the
+//  registers renamed to webs, the live interval of every web is found,
+//  linear scan gives each interval a machine register or a stack slot,
+//  and the operations are translated one by one, each reading its
+//  operands wherever they were put.
+//
+//  A register that ever holds a variable is a single web, numbered
+//  like the register, since its value may be read in any later
+//  statement.  Any other register only holds temporaries, none of
+//  which lives across one of bc.boundaries, so it is a new web in each
+//  stretch of code between two of them.
+//
+//  Positions count from 1 at the first instruction of a function;
+//  position 0 is the prologue, where parameters are loaded and
+//  variables cleared.  A web that only ever holds one small Int
+//  constant gets no location at all: its uses take the constant as an
+//  immediate operand.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <sstream>
+#include "x86-cgen.h"
+
+enum Register {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15, REGISTERS
+};
+
+static const char *register_names[REGISTERS] = {
+  "%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+  "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"
+};
+
+static const Register callee_saved[] = { RBX, R12, R13, R14, R15 };
+static const Register caller_saved[] = { RSI, RDI, R8, R9, R10, R11 };
+const int CALLEE_SAVED = sizeof callee_saved / sizeof callee_saved[0];
+const int CALLER_SAVED = sizeof caller_saved / sizeof caller_saved[0];
+
+const int ON_STACK = -1;
+
+// An instruction with its registers renamed to webs.
+struct Operation {
+  int op;
+  int a, b, c;          // webs of the instruction's registers, or -1
+  unsigned int k;       // the constant, jump target, callee or print types
+  int args, nargs;      // CALL and PRINTF: arguments[args..args+nargs-1]
+  unsigned int pc;      // the instruction
+};
+
+struct Interval {
+  int web;
+  int start, end;       // first and last positions it is live at
+  bool crosses_call;    // live before and after some call
+  int reg;              // a Register, or ON_STACK
+};
+
+static bool is_callee_saved(int reg)
+{
+  for (int i = 0; i < CALLEE_SAVED; i++)
+    if (callee_saved[i] == reg)
+      return true;
+  return false;
+}
+
+static bool is_binary(int op)
+{
+  return (op >= OP_ADD_I && op <= OP_XOR) || (op >= OP_LT_I && op <= OP_NE_F);
+}
+
+static bool is_unary(int op)
+{
+  return op >= OP_NEG_I && op <= OP_I2F;
+}
+
+static bool is_jump(int op)
+{
+  return op == OP_JMP || op == OP_JT || op == OP_JF;
+}
+
+// Whether the instruction calls out, clobbering the caller-saved
+// registers.
+static bool is_call(int op)
+{
+  return op == OP_CALL || op == OP_PRINTF || op == OP_MOD_F;
+}
+
+class FunctionCodegen {
+private:
+  Bytecode &bc;
+  ostream &s;
+  int index;                      // in bc.functions
+  BytecodeFunction &fn;
+  unsigned int end;               // one past its last instruction
+
+  std::vector<Operation> ops;
+  std::vector<int> arguments;        // webs of the CALL and PRINTF args
+  int webs;                          // those below fn.registers are
+                                     // registers holding variables
+  std::vector<bool> is_variable;     // by register
+  std::vector<int> web_of;           // by register: its web in stretch
+  std::vector<int> stretch_of;       // by register: when web_of was set
+  int stretch;                       // count of boundaries passed
+
+  std::vector<Interval> intervals;   // by web; start < 0 if unused
+  std::vector<int> defs;             // by web: the op writing it, or -2
+                                     // if more than one does
+  std::vector<bool> is_target;       // by position: a jump lands here
+  std::vector<int> offsets;          // by web: frame offset if on stack
+  std::vector<int> saved;            // callee-saved registers it uses
+  int frame;                         // bytes below the saved registers
+
+  int position(unsigned int pc) { return pc - fn.entry + 1; }
+  int web(int reg);
+  void rename();
+  void reads(const Operation &o, std::vector<int> &regs);
+  int writes(const Operation &o);
+  bool is_constant(int w);
+  long constant(int w);
+
+  void find_intervals();
+  void linear_scan(bool allocate_registers);
+  void lay_out_frame();
+
+  std::string loc(int w);
+  bool in_register(int w);
+  bool in_memory(int w);
+  void emit(const char *op, const std::string &x);
+  void emit(const char *op, const std::string &x, const std::string &y);
+  void move(const std::string &from, const std::string &to);
+  void load_xmm(int w, const char *xmm);
+  std::string label(unsigned int pc);
+
+  void binary_int(const char *op, const Operation &i);
+  void unary_int(const char *op, const Operation &i);
+  void divide(const Operation &i);
+  void binary_float(const char *op, const Operation &i);
+  void compare_float(const Operation &i);
+  void call(const Operation &i);
+  void print(const Operation &i);
+  bool compare_and_branch(size_t n);
+  void instruction(const Operation &i);
+
+public:
+  FunctionCodegen(Bytecode &b, ostream &out, int f);
+  void generate(bool allocate_registers);
+};
+
+FunctionCodegen::FunctionCodegen(Bytecode &b, ostream &out, int f)
+  : bc(b), s(out), index(f), fn(b.functions[f]), webs(0), stretch(0),
+    frame(0)
+{
+  end = f + 1 < (int) bc.functions.size() ? bc.functions[f + 1].entry
+                                          : bc.code.size();
+}
+
+// The web of register reg in the current stretch.
+int FunctionCodegen::web(int reg)
+{
+  if (is_variable[reg])
+    return reg;
+  if (stretch_of[reg] != stretch) {
+    stretch_of[reg] = stretch;
+    web_of[reg] = webs++;
+  }
+  return web_of[reg];
+}
+
+void FunctionCodegen::rename()
+{
+  is_variable.assign(fn.registers, false);
+  for (size_t k = 0; k < fn.variables.size(); k++)
+    is_variable[fn.variables[k]] = true;
+  web_of.assign(fn.registers, -1);
+  stretch_of.assign(fn.registers, -1);
+  webs = fn.registers;
+  std::vector<unsigned int>::iterator boundary =
+    std::lower_bound(bc.boundaries.begin(), bc.boundaries.end(), fn.entry);
+
+  for (unsigned int pc = fn.entry; pc < end; pc++) {
+    if (boundary != bc.boundaries.end() && *boundary == pc) {
+      stretch++;
+      boundary++;
+    }
+    const Instr &i = bc.code[pc];
+    Operation o;
+    o.op = i.op;
+    o.a = o.b = o.c = -1;
+    o.k = i.op == OP_PRINTF ? i.c : i.bc();
+    o.args = o.nargs = 0;
+    o.pc = pc;
+    if (is_binary(i.op)) {
+      o.b = web(i.b);
+      o.c = web(i.c);
+    } else if (is_unary(i.op) || i.op == OP_MOV) {
+      o.b = web(i.b);
+    } else if (i.op == OP_CALL || i.op == OP_PRINTF) {
+      o.args = arguments.size();
+      o.nargs = i.op == OP_CALL ? bc.functions[i.bc()].params : i.b;
+      for (int k = 0; k < o.nargs; k++)
+        arguments.push_back(web(i.a + k));
+    }
+    if (i.op != OP_JMP && i.op != OP_RET_VOID && i.op != OP_PRINTF)
+      o.a = web(i.a);
+    ops.push_back(o);
+  }
+}
+
+// The webs an operation reads.
+void FunctionCodegen::reads(const Operation &o, std::vector<int> &regs)
+{
+  regs.clear();
+  if (o.b >= 0)
+    regs.push_back(o.b);
+  if (o.c >= 0)
+    regs.push_back(o.c);
+  if (o.op == OP_JT || o.op == OP_JF || o.op == OP_RET)
+    regs.push_back(o.a);
+  for (int k = 0; k < o.nargs; k++)
+    regs.push_back(arguments[o.args + k]);
+}
+
+// The web an operation writes, or -1.
+int FunctionCodegen::writes(const Operation &o)
+{
+  if (is_binary(o.op) || is_unary(o.op) || o.op == OP_MOV ||
+      o.op == OP_LOADK || o.op == OP_CALL)
+    return o.a;
+  return -1;
+}
+
+static bool fits_immediate(long v)
+{
+  return v >= -0x80000000L && v <= 0x7fffffffL;
+}
+
+// Whether w is a temporary whose only value is an Int constant that
+// fits in an immediate operand.
+bool FunctionCodegen::is_constant(int w)
+{
+  if (w < fn.registers || defs[w] < 0)
+    return false;
+  const Operation &d = ops[defs[w]];
+  return d.op == OP_LOADK && bc.constant_types[d.k] == 'i' &&
+         fits_immediate(bc.constants[d.k].i);
+}
+
+long FunctionCodegen::constant(int w)
+{
+  return bc.constants[ops[defs[w]].k].i;
+}
+
+void FunctionCodegen::find_intervals()
+{
+  intervals.resize(webs);
+  defs.assign(webs, -1);
+  is_target.assign(end - fn.entry + 2, false);
+  for (int w = 0; w < webs; w++) {
+    Interval &iv = intervals[w];
+    iv.web = w;
+    iv.start = iv.end = -1;
+    iv.crosses_call = false;
+    iv.reg = ON_STACK;
+  }
+
+  std::vector<int> regs, calls;
+  std::vector<std::pair<int, int> > back_edges;
+  for (size_t n = 0; n < ops.size(); n++) {
+    const Operation &i = ops[n];
+    int p = position(i.pc);
+    reads(i, regs);
+    int w = writes(i);
+    if (w >= 0) {
+      regs.push_back(w);
+      // A second write (of a call's result, of && and ||, or of a
+      // variable) means the web holds more than one value.
+      defs[w] = defs[w] == -1 ? (int) n : -2;
+    }
+    for (size_t k = 0; k < regs.size(); k++) {
+      Interval &iv = intervals[regs[k]];
+      if (iv.start < 0)
+        iv.start = p;
+      iv.end = p;
+    }
+    if (is_call(i.op))
+      calls.push_back(p);
+    if (is_jump(i.op)) {
+      int target = position(i.k);
+      is_target[target] = true;
+      if (target <= p)
+        back_edges.push_back(std::make_pair(target, p));
+    }
+  }
+
+  // A variable keeps its value from one iteration of a loop to the
+  // next, so one used in a loop is live over all of it.
+  for (bool changed = true; changed; ) {
+    changed = false;
+    for (int v = 0; v < fn.registers; v++) {
+      Interval &iv = intervals[v];
+      if (!is_variable[v] || iv.start < 0)
+        continue;
+      iv.start = 0;
+      for (size_t e = 0; e < back_edges.size(); e++)
+        if (iv.end >= back_edges[e].first && iv.end < back_edges[e].second) {
+          iv.end = back_edges[e].second;
+          changed = true;
+        }
+    }
+  }
+
+  for (int w = 0; w < webs; w++) {
+    Interval &iv = intervals[w];
+    std::vector<int>::iterator c =
+      std::upper_bound(calls.begin(), calls.end(), iv.start);
+    iv.crosses_call = c != calls.end() && *c < iv.end;
+  }
+}
+
+static bool by_start(const Interval *x, const Interval *y)
+{
+  return x->start < y->start || (x->start == y->start && x->web < y->web);
+}
+
+static bool by_end(const Interval *x, const Interval *y)
+{
+  return x->end < y->end;
+}
+
+void FunctionCodegen::linear_scan(bool allocate_registers)
+{
+  if (!allocate_registers)
+    return;
+  std::vector<Interval *> order, active;
+  for (int w = 0; w < webs; w++)
+    if (intervals[w].start >= 0 && !is_constant(w))
+      order.push_back(&intervals[w]);
+  std::sort(order.begin(), order.end(), by_start);
+
+  bool free[REGISTERS] = { false };
+  for (int k = 0; k < CALLEE_SAVED; k++)
+    free[callee_saved[k]] = true;
+  for (int k = 0; k < CALLER_SAVED; k++)
+    free[caller_saved[k]] = true;
+
+  for (size_t n = 0; n < order.size(); n++) {
+    Interval *iv = order[n];
+
+    // An interval that ends where this one starts may share its
+    // register: every instruction reads its operands before it
+    // writes its result.
+    size_t expired = 0;
+    while (expired < active.size() && active[expired]->end <= iv->start)
+      free[active[expired++]->reg] = true;
+    active.erase(active.begin(), active.begin() + expired);
+
+    int reg = ON_STACK;
+    if (!iv->crosses_call)
+      for (int k = 0; k < CALLER_SAVED && reg == ON_STACK; k++)
+        if (free[caller_saved[k]])
+          reg = caller_saved[k];
+    for (int k = 0; k < CALLEE_SAVED && reg == ON_STACK; k++)
+      if (free[callee_saved[k]])
+        reg = callee_saved[k];
+
+    if (reg == ON_STACK) {
+      // Spill whichever of this interval and the active ones it could
+      // take a register from ends last.
+      size_t victim = active.size();
+      while (victim > 0 && iv->crosses_call &&
+             !is_callee_saved(active[victim - 1]->reg))
+        victim--;
+      if (victim == 0 || active[victim - 1]->end <= iv->end)
+        continue;
+      Interval *spilled = active[victim - 1];
+      reg = spilled->reg;
+      spilled->reg = ON_STACK;
+      active.erase(active.begin() + victim - 1);
+    }
+    iv->reg = reg;
+    free[reg] = false;
+    active.insert(std::upper_bound(active.begin(), active.end(), iv, by_end),
+                  iv);
+  }
+}
+
+// The frame below the saved rbp: the callee-saved registers the
+// function uses, then a slot for each spilled web.  A parameter on
+// the stack stays where its caller pushed it.
+void FunctionCodegen::lay_out_frame()
+{
+  bool used[REGISTERS] = { false };
+  for (int w = 0; w < webs; w++)
+    if (intervals[w].start >= 0 && intervals[w].reg != ON_STACK)
+      used[intervals[w].reg] = true;
+  for (int k = 0; k < CALLEE_SAVED; k++)
+    if (used[callee_saved[k]])
+      saved.push_back(callee_saved[k]);
+  offsets.assign(webs, 0);
+  int slots = 0;
+  for (int w = 0; w < webs; w++) {
+    if (intervals[w].start < 0 || intervals[w].reg != ON_STACK ||
+        is_constant(w))
+      continue;
+    if (w < fn.params)
+      offsets[w] = 16 + 8 * w;
+    else
+      offsets[w] = -8 * (int) (saved.size() + ++slots);
+  }
+  frame = 8 * slots;
+  if ((saved.size() + slots) % 2)
+    frame += 8;         // keep rsp 16-byte aligned for calls
+}
+
+std::string FunctionCodegen::loc(int w)
+{
+  std::ostringstream o;
+  if (is_constant(w))
+    o << "$" << constant(w);
+  else if (intervals[w].reg != ON_STACK)
+    return register_names[intervals[w].reg];
+  else
+    o << offsets[w] << "(%rbp)";
+  return o.str();
+}
+
+bool FunctionCodegen::in_register(int w)
+{
+  return !is_constant(w) && intervals[w].reg != ON_STACK;
+}
+
+bool FunctionCodegen::in_memory(int w)
+{
+  return !is_constant(w) && intervals[w].reg == ON_STACK;
+}
+
+void FunctionCodegen::emit(const char *op, const std::string &x)
+{
+  s << "\t" << op << "\t" << x << "\n";
+}
+
+void FunctionCodegen::emit(const char *op, const std::string &x,
+                           const std::string &y)
+{
+  s << "\t" << op << "\t" << x << ", " << y << "\n";
+}
+
+// mov, through rax if both operands are in memory.
+void FunctionCodegen::move(const std::string &from, const std::string &to)
+{
+  if (from == to)
+    return;
+  if (from[from.size() - 1] == ')' && to[to.size() - 1] == ')') {
+    emit("movq", from, "%rax");
+    emit("movq", "%rax", to);
+  } else {
+    emit("movq", from, to);
+  }
+}
+
+void FunctionCodegen::load_xmm(int w, const char *xmm)
+{
+  if (is_constant(w)) {
+    emit("movq", loc(w), "%rax");
+    emit("movq", "%rax", xmm);
+  } else {
+    emit("movq", loc(w), xmm);
+  }
+}
+
+std::string FunctionCodegen::label(unsigned int pc)
+{
+  std::ostringstream o;
+  o << ".L" << pc;
+  return o.str();
+}
+
+// a = b op c for add, sub, imul, and, or and xor.
+void FunctionCodegen::binary_int(const char *op, const Operation &i)
+{
+  if (in_register(i.a) && loc(i.a) != loc(i.c)) {
+    move(loc(i.b), loc(i.a));
+    emit(op, loc(i.c), loc(i.a));
+  } else {
+    emit("movq", loc(i.b), "%rax");
+    emit(op, loc(i.c), "%rax");
+    move("%rax", loc(i.a));
+  }
+}
+
+// a = op b for neg, not, and xor $1 (Bool not).
+void FunctionCodegen::unary_int(const char *op, const Operation &i)
+{
+  std::string to = in_register(i.a) ? loc(i.a) : "%rax";
+  move(loc(i.b), to);
+  if (strcmp(op, "xorq") == 0)
+    emit(op, "$1", to);
+  else if (strcmp(op, "btcq") == 0)
+    emit(op, "$63", to);
+  else
+    emit(op, to);
+  move(to, loc(i.a));
+}
+
+// DIV_I and MOD_I, which must not trap on a zero divisor or on
+// LONG_MIN / -1 as idiv does.
+void FunctionCodegen::divide(const Operation &i)
+{
+  bool mod = i.op == OP_MOD_I;
+  bool plain = is_constant(i.c) && constant(i.c) != 0 && constant(i.c) != -1;
+  emit("movq", loc(i.c), "%rcx");
+  if (!is_constant(i.c) || constant(i.c) == 0) {
+    std::ostringstream line;
+    line << "$" << bc.lines[i.pc];
+    emit("testq", "%rcx", "%rcx");
+    emit("jne", "1f");
+    emit("movq", line.str(), "%rdi");
+    emit("call", "seal_division_by_zero");
+    s << "1:\n";
+  }
+  emit("movq", loc(i.b), "%rax");
+  if (!plain) {
+    emit("cmpq", "$-1", "%rcx");
+    emit("jne", "2f");
+    if (mod)
+      emit("xorl", "%eax", "%eax");
+    else
+      emit("negq", "%rax");
+    emit("jmp", "3f");
+    s << "2:\n";
+  }
+  emit("cqto", "");
+  emit("idivq", "%rcx");
+  if (mod)
+    emit("movq", "%rdx", "%rax");
+  if (!plain)
+    s << "3:\n";
+  move("%rax", loc(i.a));
+}
+
+void FunctionCodegen::binary_float(const char *op, const Operation &i)
+{
+  load_xmm(i.b, "%xmm0");
+  load_xmm(i.c, "%xmm1");
+  if (i.op == OP_MOD_F)
+    emit("call", "seal_fmod");
+  else
+    emit(op, "%xmm1", "%xmm0");
+  emit("movq", "%xmm0", loc(i.a));
+}
+
+// ucomisd sets the flags as an unsigned compare would, and sets PF
+// if either operand is NaN, for which only != is true.
+void FunctionCodegen::compare_float(const Operation &i)
+{
+  load_xmm(i.b, "%xmm0");
+  load_xmm(i.c, "%xmm1");
+  switch (i.op) {
+  case OP_LT_F:
+  case OP_LE_F:
+    emit("ucomisd", "%xmm0", "%xmm1");
+    emit(i.op == OP_LT_F ? "seta" : "setae", "%al");
+    break;
+  case OP_GT_F:
+  case OP_GE_F:
+    emit("ucomisd", "%xmm1", "%xmm0");
+    emit(i.op == OP_GT_F ? "seta" : "setae", "%al");
+    break;
+  case OP_EQ_F:
+    emit("ucomisd", "%xmm1", "%xmm0");
+    emit("sete", "%al");
+    emit("setnp", "%cl");
+    emit("andb", "%cl", "%al");
+    break;
+  default:
+    emit("ucomisd", "%xmm1", "%xmm0");
+    emit("setne", "%al");
+    emit("setp", "%cl");
+    emit("orb", "%cl", "%al");
+    break;
+  }
+  emit("movzbl", "%al", "%eax");
+  move("%rax", loc(i.a));
+}
+
+// Check for stack overflow, then push the arguments, the first one
+// last, padding to keep rsp 16-byte aligned.
+void FunctionCodegen::call(const Operation &i)
+{
+  BytecodeFunction &callee = bc.functions[i.k];
+  int n = i.nargs;
+  std::ostringstream line;
+  line << "$" << bc.lines[i.pc];
+  emit("cmpq", "seal_stack_limit(%rip)", "%rsp");
+  emit("jae", "1f");
+  emit("movq", line.str(), "%rdi");
+  emit("call", "seal_stack_overflow");
+  s << "1:\n";
+  if (n % 2)
+    emit("subq", "$8", "%rsp");
+  for (int k = n - 1; k >= 0; k--)
+    emit("pushq", loc(arguments[i.args + k]));
+  emit("call", std::string("seal.") + callee.name);
+  if (n > 0) {
+    std::ostringstream pop;
+    pop << "$" << 8 * (n + n % 2);
+    emit("addq", pop.str(), "%rsp");
+  }
+  move("%rax", loc(i.a));
+}
+
+// seal_printf(types, args) with the arguments copied to the stack.
+void FunctionCodegen::print(const Operation &i)
+{
+  int bytes = (8 * i.nargs + 15) & ~15;
+  std::ostringstream size, types;
+  size << "$" << bytes;
+  types << ".LT" << i.k << "(%rip)";
+  emit("subq", size.str(), "%rsp");
+  for (int k = 0; k < i.nargs; k++) {
+    std::ostringstream slot;
+    slot << 8 * k << "(%rsp)";
+    move(loc(arguments[i.args + k]), slot.str());
+  }
+  emit("leaq", types.str(), "%rdi");
+  emit("movq", "%rsp", "%rsi");
+  emit("call", "seal_printf");
+  emit("addq", size.str(), "%rsp");
+}
+
+static const char *int_conditions[] = { "l", "le", "g", "ge", "e", "ne" };
+static const char *negated_conditions[] = { "ge", "g", "le", "l", "ne", "e" };
+
+// An Int comparison whose only use is the JT or JF after it is done
+// with one cmp and a conditional jump.  Returns false if it is not.
+bool FunctionCodegen::compare_and_branch(size_t n)
+{
+  const Operation &i = ops[n];
+  std::string cmp_b = loc(i.b);
+  if (!in_register(i.b) && (is_constant(i.b) || in_memory(i.c))) {
+    emit("movq", loc(i.b), "%rax");
+    cmp_b = "%rax";
+  }
+  emit("cmpq", loc(i.c), cmp_b);
+
+  const Operation &next = ops[n + 1 < ops.size() ? n + 1 : n];
+  bool fuse = n + 1 < ops.size() && (next.op == OP_JT || next.op == OP_JF) &&
+              next.a == i.a && intervals[i.a].end == position(next.pc) &&
+              !is_target[position(next.pc)];
+  int k = i.op - OP_LT_I;
+  if (!fuse) {
+    emit((std::string("set") + int_conditions[k]).c_str(), "%al");
+    emit("movzbl", "%al", "%eax");
+    move("%rax", loc(i.a));
+    return false;
+  }
+  const char *cc = next.op == OP_JT ? int_conditions[k] : negated_conditions[k];
+  emit((std::string("j") + cc).c_str(), label(next.k));
+  return true;
+}
+
+void FunctionCodegen::instruction(const Operation &i)
+{
+  switch (i.op) {
+  case OP_MOV:
+    move(loc(i.b), loc(i.a));
+    break;
+  case OP_LOADK:
+    if (is_constant(i.a))
+      break;
+    if (bc.constant_types[i.k] == 's') {
+      std::ostringstream c;
+      c << ".LC" << i.k << "(%rip)";
+      std::string to = in_register(i.a) ? loc(i.a) : "%rax";
+      emit("leaq", c.str(), to);
+      move(to, loc(i.a));
+    } else {
+      std::ostringstream c;
+      c << "$" << bc.constants[i.k].i;
+      if (fits_immediate(bc.constants[i.k].i)) {
+        emit("movq", c.str(), loc(i.a));
+      } else {
+        emit("movabsq", c.str(), "%rax");
+        move("%rax", loc(i.a));
+      }
+    }
+    break;
+  case OP_ADD_I: binary_int("addq", i); break;
+  case OP_SUB_I: binary_int("subq", i); break;
+  case OP_MUL_I: binary_int("imulq", i); break;
+  case OP_AND: binary_int("andq", i); break;
+  case OP_OR: binary_int("orq", i); break;
+  case OP_XOR: binary_int("xorq", i); break;
+  case OP_DIV_I:
+  case OP_MOD_I:
+    divide(i);
+    break;
+  case OP_ADD_F: binary_float("addsd", i); break;
+  case OP_SUB_F: binary_float("subsd", i); break;
+  case OP_MUL_F: binary_float("mulsd", i); break;
+  case OP_DIV_F: binary_float("divsd", i); break;
+  case OP_MOD_F: binary_float("", i); break;
+  case OP_NEG_I: unary_int("negq", i); break;
+  case OP_NEG_F: unary_int("btcq", i); break;
+  case OP_NOT: unary_int("xorq", i); break;
+  case OP_BITNOT: unary_int("notq", i); break;
+  case OP_I2F:
+    if (is_constant(i.b)) {
+      emit("movq", loc(i.b), "%rax");
+      emit("cvtsi2sdq", "%rax", "%xmm0");
+    } else {
+      emit("pxor", "%xmm0", "%xmm0");
+      emit("cvtsi2sdq", loc(i.b), "%xmm0");
+    }
+    emit("movq", "%xmm0", loc(i.a));
+    break;
+  case OP_LT_I: case OP_LE_I: case OP_GT_I:
+  case OP_GE_I: case OP_EQ_I: case OP_NE_I:
+    break;      // done by compare_and_branch
+  case OP_LT_F: case OP_LE_F: case OP_GT_F:
+  case OP_GE_F: case OP_EQ_F: case OP_NE_F:
+    compare_float(i);
+    break;
+  case OP_JMP:
+    emit("jmp", label(i.k));
+    break;
+  case OP_JT:
+  case OP_JF:
+    if (is_constant(i.a)) {
+      if ((constant(i.a) != 0) == (i.op == OP_JT))
+        emit("jmp", label(i.k));
+    } else {
+      if (in_register(i.a))
+        emit("testq", loc(i.a), loc(i.a));
+      else
+        emit("cmpq", "$0", loc(i.a));
+      emit(i.op == OP_JT ? "jne" : "je", label(i.k));
+    }
+    break;
+  case OP_CALL:
+    call(i);
+    break;
+  case OP_RET:
+    emit("movq", loc(i.a), "%rax");
+    // fall through
+  case OP_RET_VOID:
+    // The last instruction is a RET_VOID, which falls into the
+    // epilogue, so neither it nor the one before it need jump there.
+    if (i.pc + 2 < end) {
+      std::ostringstream ret;
+      ret << ".Lret" << index;
+      emit("jmp", ret.str());
+    }
+    break;
+  case OP_PRINTF:
+    print(i);
+    break;
+  }
+}
+
+void FunctionCodegen::generate(bool allocate_registers)
+{
+  rename();
+  find_intervals();
+  linear_scan(allocate_registers);
+  lay_out_frame();
+
+  s << "\n\t.globl\tseal." << fn.name << "\n"
+    << "\t.type\tseal." << fn.name << ", @function\n"
+    << "seal." << fn.name << ":\n";
+  emit("pushq", "%rbp");
+  emit("movq", "%rsp", "%rbp");
+  for (size_t k = 0; k < saved.size(); k++)
+    emit("pushq", register_names[saved[k]]);
+  if (frame > 0) {
+    std::ostringstream size;
+    size << "$" << frame;
+    emit("subq", size.str(), "%rsp");
+  }
+  for (int v = 0; v < fn.registers; v++) {
+    if (!is_variable[v] || intervals[v].start < 0)
+      continue;
+    if (v < fn.params) {
+      if (in_register(v)) {
+        std::ostringstream arg;
+        arg << 16 + 8 * v << "(%rbp)";
+        emit("movq", arg.str(), loc(v));
+      }
+    } else {
+      emit("movq", "$0", loc(v));
+    }
+  }
+
+  for (size_t n = 0; n < ops.size(); n++) {
+    const Operation &i = ops[n];
+    if (is_target[position(i.pc)])
+      s << label(i.pc) << ":\n";
+    if (i.op >= OP_LT_I && i.op <= OP_NE_I) {
+      if (compare_and_branch(n))
+        n++;
+      continue;
+    }
+    instruction(i);
+  }
+
+  s << ".Lret" << index << ":\n";
+  if (!saved.empty()) {
+    std::ostringstream top;
+    top << -8 * (int) saved.size() << "(%rbp)";
+    emit("leaq", top.str(), "%rsp");
+  } else if (frame > 0) {
+    emit("movq", "%rbp", "%rsp");
+  }
+  for (size_t k = saved.size(); k > 0; k--)
+    emit("popq", register_names[saved[k - 1]]);
+  emit("popq", "%rbp");
+  s << "\tret\n"
+    << "\t.size\tseal." << fn.name << ", .-seal." << fn.name << "\n";
+}
+
+static void emit_string(ostream &s, const char *str)
+{
+  s << "\"";
+  for (const unsigned char *p = (const unsigned char *) str; *p; p++) {
+    if (*p == '"' || *p == '\\')
+      s << '\\' << *p;
+    else if (*p >= ' ' && *p < 127)
+      s << *p;
+    else {
+      char octal[8];
+      snprintf(octal, sizeof octal, "\\%03o", *p);
+      s << octal;
+    }
+  }
+  s << "\"";
+}
+
+void emit_x86_64(Bytecode &bc, ostream &s, bool allocate_registers)
+{
+  s << "\t.text\n";
+  for (size_t f = 0; f < bc.functions.size(); f++) {
+    FunctionCodegen codegen(bc, s, f);
+    codegen.generate(allocate_registers);
+  }
+  if (bc.main >= 0)
+    s << "\n\t.globl\tseal_start\n"
+      << "\t.set\tseal_start, seal." << bc.functions[bc.main].name << "\n";
+
+  s << "\n\t.section\t.rodata\n";
+  for (size_t k = 0; k < bc.constants.size(); k++)
+    if (bc.constant_types[k] == 's') {
+      s << ".LC" << k << ":\n\t.string\t";
+      emit_string(s, bc.constants[k].s);
+      s << "\n";
+    }
+  for (size_t k = 0; k < bc.print_types.size(); k++)
+    s << ".LT" << k << ":\n\t.string\t\"" << bc.print_types[k] << "\"\n";
+  s << "\t.section\t.note.GNU-stack,\"\",@progbits\n";
+}
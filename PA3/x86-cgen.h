@@ -0,0 +1,49 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef X86_CGEN_H
+#define X86_CGEN_H
+//////////////////////////////////////////////////////////////////////
+//
+//  x86-cgen.h
+//
+//  A native code generator: translates the bytecode of a checked
+//  program (see bytecode.h) into x86-64 assembly for the GNU assembler,
+//  to be linked with the C runtime in seal-runtime.c:
+//
+//     semant -S prog.seal -o prog.s
+//     gcc prog.s seal-runtime.c -lm -o prog
+//
+//  The compiler reuses a temporary's register from one statement to
+//  the next, so the registers are first split into webs: a temporary's
+//  register is a new web after each of bc.boundaries, and a register
+//  that holds a variable is one web.  Webs are mapped to machine
+//  registers by linear scan (Poletto and Sarkar): each one is live over
+//  a single interval of instruction positions, a variable's from the
+//  function entry, where it is set to zero, to its last use, stretched
+//  over every loop it is used in.  Intervals that contain a call get
+//  callee-saved registers only; when the registers run out, the
+//  interval that ends last goes to the stack.  rax, rcx and rdx are
+//  left free as scratch registers.
+//
+//  Every value is kept in a 64-bit general register; Float operations
+//  move their operands into xmm0 and xmm1.  A Seal function with n
+//  arguments is called with them pushed on the stack, the first one
+//  last, and returns its result in rax.  Function f is the symbol
+//  seal.f, which no C name can clash with; the runtime enters main
+//  through seal_start.
+//
+//     void emit_x86_64(Bytecode &bc, ostream &s, bool allocate_registers)
+//       writes the program to s.  Without allocate_registers (-r),
+//       every web lives on the stack.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "bytecode.h"
+
+void emit_x86_64(Bytecode &bc, ostream &s, bool allocate_registers);
+
+#endif